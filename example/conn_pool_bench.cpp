@@ -0,0 +1,137 @@
+// latency and throughput for evtlet::conn_pool, against a loopback
+// stand-in server
+//
+// usage: conn_pool_bench [nfibers [ncalls]]
+//
+// each configuration is run with write batching disabled (max_batch = 1)
+// and enabled, for a range of pool sizes
+//
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/fiber/fiber.hpp>
+
+#include <evtlet/io/conn_pool.hpp>
+#include <evtlet/io/fd_stream.hpp>
+
+using clock_type = std::chrono::steady_clock;
+
+class line_conn {
+private:
+  evtlet::fd_stream m_stream;
+  std::string m_buf;
+
+public:
+  explicit line_conn(int fd) : m_stream(fd), m_buf() {}
+
+  size_t writev(struct iovec *iov, int iovcnt) {
+    return m_stream.writev(iov, iovcnt);
+  }
+
+  std::string read_response() {
+    size_t pos;
+    while ((pos = m_buf.find('\n')) == std::string::npos) {
+      char chunk[4096];
+      const size_t nn = m_stream.read_some(chunk, sizeof(chunk));
+      if (nn == 0) {
+        throw std::runtime_error("connection closed");
+      }
+      m_buf.append(chunk, nn);
+    }
+    std::string line = m_buf.substr(0, pos);
+    m_buf.erase(0, pos + 1);
+    return line;
+  }
+};
+
+static void echo_server(int fd) {
+  std::string buf;
+  char chunk[4096];
+  while (true) {
+    const ssize_t nn = ::read(fd, chunk, sizeof(chunk));
+    if (nn <= 0) {
+      break;
+    }
+    buf.append(chunk, static_cast<size_t>(nn));
+    const size_t last = buf.rfind('\n');
+    if (last != std::string::npos) {
+      if (::write(fd, buf.data(), last + 1) < 0) {
+        break;
+      }
+      buf.erase(0, last + 1);
+    }
+  }
+  ::close(fd);
+}
+
+static void run(size_t nconns, size_t max_batch, size_t nfibers,
+                size_t ncalls) {
+  std::vector<std::thread> servers;
+  std::vector<line_conn> conns;
+  for (size_t ii = 0; ii < nconns; ++ii) {
+    int sv[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+      throw std::runtime_error("socketpair");
+    }
+    servers.emplace_back(echo_server, sv[1]);
+    conns.emplace_back(sv[0]);
+  }
+
+  std::vector<double> lat_us;
+  lat_us.reserve(nfibers * ncalls);
+  const auto t0 = clock_type::now();
+  {
+    evtlet::conn_pool<line_conn, std::string> pool(std::move(conns),
+                                                   max_batch);
+    std::vector<boost::fibers::fiber> clients;
+    for (size_t ff = 0; ff < nfibers; ++ff) {
+      clients.emplace_back([&pool, &lat_us, ncalls]() {
+        const std::string req = "ping\n";
+        for (size_t cc = 0; cc < ncalls; ++cc) {
+          const auto ts = clock_type::now();
+          static_cast<void>(pool.call(req));
+          const std::chrono::duration<double, std::micro> dt =
+              clock_type::now() - ts;
+          lat_us.push_back(dt.count());
+        }
+      });
+    }
+    for (auto &cl : clients) {
+      cl.join();
+    }
+  }
+  const std::chrono::duration<double> elapsed = clock_type::now() - t0;
+  for (auto &srv : servers) {
+    srv.join();
+  }
+
+  std::sort(lat_us.begin(), lat_us.end());
+  const auto pct = [&lat_us](double pp) {
+    return lat_us[static_cast<size_t>(pp * static_cast<double>(lat_us.size() - 1))];
+  };
+  std::cout << "conns=" << nconns << " max_batch=" << max_batch
+            << " calls/s=" << static_cast<double>(lat_us.size()) / elapsed.count()
+            << " p50_us=" << pct(0.5) << " p99_us=" << pct(0.99)
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  const size_t nfibers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+  const size_t ncalls = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+  std::cout << "fibers=" << nfibers << " calls/fiber=" << ncalls << std::endl;
+  for (size_t nconns : {1, 2, 4}) {
+    for (size_t max_batch : {1, 64}) {
+      run(nconns, max_batch, nfibers, ncalls);
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+// synthetic benchmark for NUMA placement with evtlet::worker_pool
+//
+// usage: numa_bench [nthreads [ntasks [nelts]]]
+//
+// each worker thread produces `ntasks` fibers, each summing one slice of an
+// array allocated on the worker's NUMA node. With PLACE_PIN, idle workers
+// steal from any other worker; with PLACE_NUMA, idle workers steal from
+// workers on the same node first. A task is counted as remote when run on
+// a thread of a different node than its data.
+//
+// on a host with a single NUMA node, both runs should be equivalent
+//
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/fiber.hpp>
+
+#include <evtlet/rt/numa_alloc.hpp>
+#include <evtlet/rt/worker_pool.hpp>
+#include <evtlet/sync/latch.hpp>
+#include <evtlet/util/numa.hpp>
+
+using clock_type = std::chrono::steady_clock;
+
+static void run(const char *name, evtlet::placement place, size_t nthreads,
+                size_t ntasks, size_t nelts) {
+  // declared before the pool, such that workers will have returned from
+  // count_down() before the latch is destroyed
+  const size_t nworkers = (nthreads ? nthreads : 1) - 1;
+  evtlet::latch done(static_cast<ptrdiff_t>(nworkers));
+  evtlet::worker_pool pool(nthreads, false, place);
+
+  std::vector<std::unique_ptr<evtlet::numa_resource>> resources;
+  std::vector<std::pmr::vector<double>> data;
+  for (size_t ww = 1; ww <= nworkers; ++ww) {
+    resources.emplace_back(
+        std::make_unique<evtlet::numa_resource>(pool.node_of(ww)));
+    data.emplace_back(nelts, 1.0, resources.back().get());
+  }
+
+  std::atomic<size_t> nremote{0};
+  std::atomic<double> total{0.0};
+  const size_t slice = nelts / ntasks ? nelts / ntasks : 1;
+  const auto t0 = clock_type::now();
+  for (size_t ww = 1; ww <= nworkers; ++ww) {
+    const int node = pool.node_of(ww);
+    const auto &arr = data[ww - 1];
+    pool.post(ww, [&, node, ntasks, slice]() {
+      evtlet::latch tasks(static_cast<ptrdiff_t>(ntasks));
+      for (size_t tt = 0; tt < ntasks; ++tt) {
+        boost::fibers::fiber(
+            std::allocator_arg, evtlet::numa_stack(),
+            [&, node, tt]() {
+              if (evtlet::numa_thread_node() != node) {
+                nremote.fetch_add(1, std::memory_order_relaxed);
+              }
+              double sum = 0.0;
+              const size_t first = (tt * slice) % arr.size();
+              for (size_t rep = 0; rep < 16; ++rep) {
+                for (size_t ii = first; ii < first + slice && ii < arr.size();
+                     ++ii) {
+                  sum += arr[ii];
+                }
+              }
+              total.fetch_add(sum, std::memory_order_relaxed);
+              tasks.count_down();
+            })
+            .detach();
+      }
+      tasks.wait();
+      done.count_down();
+    });
+  }
+  done.wait();
+  const std::chrono::duration<double> elapsed = clock_type::now() - t0;
+  const double ntotal = static_cast<double>(nworkers * ntasks);
+  std::cout << name << ": tasks/s=" << ntotal / elapsed.count()
+            << " remote=" << nremote.load() << "/" << nworkers * ntasks
+            << " checksum=" << total.load() << std::endl;
+}
+
+int main(int argc, char **argv) {
+  const size_t nthreads =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+               : std::max(2U, std::thread::hardware_concurrency());
+  const size_t ntasks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+  const size_t nelts = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1 << 20;
+  std::cout << "nodes=" << evtlet::numa_topology().size()
+            << " threads=" << nthreads << std::endl;
+  run("PLACE_PIN", evtlet::placement::PLACE_PIN, nthreads, ntasks, nelts);
+  run("PLACE_NUMA", evtlet::placement::PLACE_NUMA, nthreads, ntasks, nelts);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""loopback echo benchmark for the evtlet module, compared with gevent
+
+Each implementation runs a server and its clients in one process and one
+thread, over TCP on 127.0.0.1. Each client sends `--msgs` messages of
+`--size` bytes, waiting for each echo before sending the next.
+
+implementations:
+  evtlet         echo handlers as Python tasks, with evtlet.Stream I/O
+  evtlet-native  echo handlers as native tasks, with evtlet.echo()
+  gevent         gevent.server.StreamServer, with gevent sockets
+
+usage, with the module built for EVTLET_PYTHON:
+  $ PYTHONPATH=<build>/python python3 python/echo_bench.py
+"""
+
+import argparse
+import socket
+import subprocess
+import sys
+import time
+
+IMPLS = ("evtlet", "evtlet-native", "gevent")
+
+
+def _recv_exact(recv, nbytes):
+    nread = 0
+    while nread < nbytes:
+        data = recv(nbytes - nread)
+        if not data:
+            raise ConnectionError("connection closed by server")
+        nread += len(data)
+
+
+def bench_evtlet(args, native):
+    import evtlet
+
+    lsock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    lsock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    lsock.bind(("127.0.0.1", 0))
+    lsock.listen(args.conns)
+    port = lsock.getsockname()[1]
+    listener = evtlet.Listener(lsock.detach())
+    payload = b"x" * args.size
+    handlers = []
+
+    def echo(stream):
+        while True:
+            data = stream.recv(65536)
+            if not data:
+                break
+            stream.send(data)
+        stream.close()
+
+    def serve():
+        for _ in range(args.conns):
+            stream = listener.accept()
+            if native:
+                handlers.append(evtlet.echo(stream))
+            else:
+                handlers.append(evtlet.spawn(echo, stream))
+
+    def client():
+        # the listen backlog holds each connection, until accepted
+        sock = socket.create_connection(("127.0.0.1", port))
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        stream = evtlet.Stream(sock.detach())
+        for _ in range(args.msgs):
+            stream.send(payload)
+            _recv_exact(stream.recv, len(payload))
+        stream.close()
+
+    start = time.perf_counter()
+    server = evtlet.spawn(serve)
+    clients = [evtlet.spawn(client) for _ in range(args.conns)]
+    for task in clients:
+        task.get()
+    server.get()
+    evtlet.joinall(handlers)
+    elapsed = time.perf_counter() - start
+    listener.close()
+    return elapsed
+
+
+def bench_gevent(args):
+    import gevent
+    import gevent.socket
+    from gevent.server import StreamServer
+
+    payload = b"x" * args.size
+
+    def echo(sock, _addr):
+        while True:
+            data = sock.recv(65536)
+            if not data:
+                break
+            sock.sendall(data)
+
+    server = StreamServer(("127.0.0.1", 0), echo, backlog=args.conns)
+    server.start()
+    port = server.server_port
+
+    def client():
+        sock = gevent.socket.create_connection(("127.0.0.1", port))
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        for _ in range(args.msgs):
+            sock.sendall(payload)
+            _recv_exact(sock.recv, len(payload))
+        sock.close()
+
+    start = time.perf_counter()
+    jobs = [gevent.spawn(client) for _ in range(args.conns)]
+    gevent.joinall(jobs, raise_error=True)
+    elapsed = time.perf_counter() - start
+    server.stop()
+    return elapsed
+
+
+def run_one(args):
+    if args.impl == "gevent":
+        elapsed = bench_gevent(args)
+    else:
+        elapsed = bench_evtlet(args, args.impl == "evtlet-native")
+    trips = args.conns * args.msgs
+    print(f"{args.impl:<14} {args.conns:>6} {args.msgs:>6} {args.size:>6} "
+          f"{elapsed:>9.3f} {trips / elapsed:>12.0f}")
+
+
+def run_all(args):
+    # each implementation in its own process, e.g such that gevent's hub
+    # is not shared with evtlet
+    print(f"{'impl':<14} {'conns':>6} {'msgs':>6} {'size':>6} "
+          f"{'seconds':>9} {'trips/s':>12}")
+    sys.stdout.flush()
+    for impl in IMPLS:
+        cmd = [sys.executable, __file__, "--impl", impl,
+               "--conns", str(args.conns), "--msgs", str(args.msgs),
+               "--size", str(args.size)]
+        proc = subprocess.run(cmd, capture_output=True, text=True)
+        if proc.returncode == 0:
+            print(proc.stdout, end="")
+        else:
+            err = proc.stderr.strip().splitlines()
+            print(f"{impl:<14} skipped: {err[-1] if err else proc.returncode}")
+        sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--impl", choices=IMPLS,
+                        help="run only this implementation, in-process")
+    parser.add_argument("--conns", type=int, default=64,
+                        help="number of concurrent connections")
+    parser.add_argument("--msgs", type=int, default=2000,
+                        help="messages per connection")
+    parser.add_argument("--size", type=int, default=64,
+                        help="message size in bytes")
+    args = parser.parse_args()
+    if args.impl:
+        run_one(args)
+    else:
+        run_all(args)
+
+
+if __name__ == "__main__":
+    main()
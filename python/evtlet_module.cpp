@@ -0,0 +1,799 @@
+/**
+ * @file evtlet_module.cpp
+ * @brief Python module for evtlet events and fiber-blocking I/O
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+// Python callables are run as event fibers on the calling thread, as with
+// greenlet and gevent, though without monkey-patching. Each fiber running
+// Python code has its own interpreter thread state. The GIL is released,
+// and the thread state saved, only around a fiber switch in this module,
+// such that each Python fiber resumes with its own frames.
+//
+// The module uses the Python C API directly. Binding libraries may hold
+// state per OS thread for the duration of each bound call, e.g the
+// `loader_life_support` stack in pybind11, which expects calls on one
+// thread to return in LIFO order. Calls suspended across a fiber switch
+// would return out of order. Here, no state is held across a fiber switch
+// other than each fiber's own thread state. For the same reason, the fiber
+// code does not use `PyGILState`, which would find the thread state of the
+// thread's main fiber.
+//
+// CPython's debug memory hooks, e.g with `-X dev` or `PYTHONMALLOC=debug`,
+// check for the GIL with `PyGILState_Check()` and will abort for a
+// fiber's thread state. `-X dev` can be used with `PYTHONMALLOC=malloc`.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_call.hpp>
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/io/fd_stream.hpp>
+
+namespace evtlet {
+namespace python {
+
+/// default stack size for fibers running Python code
+constexpr size_t py_stack_size_default = 256 * 1024;
+
+static std::atomic<size_t> py_stack_size{py_stack_size_default};
+
+/**
+ * @brief owned reference to a Python object
+ *
+ * Instances must be copied, assigned and destroyed only with the GIL held,
+ * unless null. Moves do not require the GIL.
+ */
+class py_ref {
+private:
+  PyObject *m_obj;
+
+public:
+  py_ref() noexcept : m_obj(nullptr) {}
+
+  /// take ownership of a new reference
+  explicit py_ref(PyObject *obj) noexcept : m_obj(obj) {}
+
+  py_ref(py_ref const &other) noexcept : m_obj(other.m_obj) {
+    Py_XINCREF(m_obj);
+  }
+
+  py_ref(py_ref &&other) noexcept : m_obj(std::exchange(other.m_obj, nullptr)) {}
+
+  py_ref &operator=(py_ref other) noexcept {
+    std::swap(m_obj, other.m_obj);
+    return *this;
+  }
+
+  ~py_ref() { Py_XDECREF(m_obj); }
+
+  /// a new reference to a borrowed object
+  static py_ref borrow(PyObject *obj) noexcept {
+    Py_XINCREF(obj);
+    return py_ref(obj);
+  }
+
+  PyObject *get() const noexcept { return m_obj; }
+
+  /// a new reference to the object, for return to Python
+  PyObject *new_ref() const noexcept {
+    Py_XINCREF(m_obj);
+    return m_obj;
+  }
+
+  explicit operator bool() const noexcept { return m_obj != nullptr; }
+};
+
+/**
+ * @brief release the GIL for the calling fiber, e.g across a fiber switch
+ *
+ * The fiber's thread state is saved and then restored on destruction.
+ */
+class gil_release {
+private:
+  PyThreadState *m_ts;
+
+public:
+  gil_release() noexcept : m_ts(PyEval_SaveThread()) {}
+
+  ~gil_release() { PyEval_RestoreThread(m_ts); }
+
+  /// not copyable
+  gil_release(gil_release const &) = delete;
+
+  /// not assignable
+  gil_release &operator=(gil_release const &) = delete;
+};
+
+/// exception for a Python error that has been set, e.g by the C API
+class py_error_set : public std::exception {
+public:
+  const char *what() const noexcept override { return "Python error set"; }
+};
+
+/**
+ * @brief call `fn` for a module function, with the GIL held
+ *
+ * A C++ exception will be raised as a Python exception.
+ *
+ * @return the result of `fn`, or nullptr with a Python error set
+ */
+template <typename F> static PyObject *py_call(F &&fn) noexcept {
+  try {
+    return fn();
+  } catch (const py_error_set &) {
+    // the error is set
+  } catch (const std::system_error &exc) {
+    PyObject *args = Py_BuildValue("(is)", exc.code().value(), exc.what());
+    if (args) {
+      PyErr_SetObject(PyExc_OSError, args);
+      Py_DECREF(args);
+    }
+  } catch (const std::bad_alloc &) {
+    PyErr_NoMemory();
+  } catch (const std::exception &exc) {
+    PyErr_SetString(PyExc_RuntimeError, exc.what());
+  }
+  return nullptr;
+}
+
+/**
+ * @brief interface for a task held by the `task_registry`
+ */
+class task_base {
+public:
+  virtual ~task_base() = default;
+
+  /// wait for the task to complete. Called without the GIL
+  virtual void task_wait() = 0;
+
+  virtual bool task_done() noexcept = 0;
+
+  /**
+   * @brief the task's value as a new reference
+   *
+   * Called with the GIL, after `task_wait()`. This will return nullptr
+   * with the task's Python exception set, or may throw.
+   */
+  virtual PyObject *task_value() = 0;
+};
+
+/**
+ * @brief tasks on the calling thread, held until complete
+ *
+ * A task's fiber does not hold a reference to the task. The registry
+ * holds each task until the task is done, then releases it on some later
+ * call from Python, with the GIL held.
+ */
+class task_registry {
+private:
+  std::vector<std::shared_ptr<task_base>> m_tasks;
+
+public:
+  task_registry() = default;
+
+  /// not copyable
+  task_registry(task_registry const &) = delete;
+
+  /// not assignable
+  task_registry &operator=(task_registry const &) = delete;
+
+  static task_registry &instance() {
+    // not destroyed at thread exit, where the GIL may not be held
+    static thread_local task_registry *reg = new task_registry();
+    return *reg;
+  }
+
+  void hold(std::shared_ptr<task_base> task) {
+    reap();
+    m_tasks.push_back(std::move(task));
+  }
+
+  /// release each completed task. Called with the GIL
+  void reap() {
+    // A completed task's fiber will not switch again before exiting, and
+    // will not be running here, on the same thread
+    std::erase_if(m_tasks, [](const std::shared_ptr<task_base> &task) {
+      return task->task_done();
+    });
+  }
+
+  size_t size() const noexcept { return m_tasks.size(); }
+};
+
+/**
+ * @brief event fiber for a Python callable
+ *
+ * The callable will be run on its own fiber, with a new thread state.
+ * An exception raised by the callable will be raised again for
+ * `task_value()`.
+ */
+class py_task : public evt_fiber<py_ref, boost::fibers::mutex,
+                                 boost::fibers::condition_variable,
+                                 boost::fibers::fixedsize_stack>,
+                public task_base {
+public:
+  using base_t = evt_fiber<py_ref, boost::fibers::mutex,
+                           boost::fibers::condition_variable,
+                           boost::fibers::fixedsize_stack>;
+
+private:
+  PyInterpreterState *m_interp;
+  size_t m_stack_size;
+  py_ref m_fn;
+  py_ref m_args;
+  py_ref m_kwargs;
+  py_ref m_error;
+
+public:
+  /// create and dispatch the task. Called with the GIL
+  py_task(py_ref fn, py_ref args, py_ref kwargs)
+      : base_t(scheduling::SCHED_DEFER), m_interp(PyInterpreterState_Get()),
+        m_stack_size(py_stack_size.load(std::memory_order_relaxed)),
+        m_fn(std::move(fn)), m_args(std::move(args)),
+        m_kwargs(std::move(kwargs)), m_error() {
+    this->dispatch_detached();
+  }
+
+  void task_wait() override { this->wait(); }
+
+  bool task_done() noexcept override { return this->done(); }
+
+  PyObject *task_value() override {
+    if (m_error) {
+      PyObject *exc = m_error.get();
+      PyErr_SetObject(reinterpret_cast<PyObject *>(Py_TYPE(exc)), exc);
+      return nullptr;
+    }
+    return this->get().new_ref();
+  }
+
+protected:
+  stack_t _make_stack_allocator() override { return stack_t(m_stack_size); }
+
+  py_ref func() override {
+    PyThreadState *ts = PyThreadState_New(m_interp);
+    PyEval_RestoreThread(ts);
+    py_ref result(PyObject_Call(m_fn.get(), m_args.get(), m_kwargs.get()));
+    if (!result) {
+      m_error = _fetch_error();
+      result = py_ref::borrow(Py_None);
+    }
+    // release the callable and arguments while the GIL is held
+    m_fn = py_ref();
+    m_args = py_ref();
+    m_kwargs = py_ref();
+    PyThreadState_Clear(ts);
+    PyThreadState_DeleteCurrent();
+    return result;
+  }
+
+  /// the current Python exception as a normalized exception instance
+  static py_ref _fetch_error() {
+    PyObject *type = nullptr;
+    PyObject *value = nullptr;
+    PyObject *tb = nullptr;
+    PyErr_Fetch(&type, &value, &tb);
+    PyErr_NormalizeException(&type, &value, &tb);
+    if (tb) {
+      PyException_SetTraceback(value, tb);
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(tb);
+    return py_ref(value);
+  }
+};
+
+/// Python object for a native value
+inline PyObject *to_python(size_t value) { return PyLong_FromSize_t(value); }
+
+/**
+ * @brief event fiber for a native callable, run without the GIL
+ *
+ * @tparam T return value type for the callable, convertible with
+ *         `to_python()`
+ */
+template <typename T>
+class native_task : public evt_call<T>, public task_base {
+public:
+  explicit native_task(typename evt_call<T>::func_t &&fn)
+      : evt_call<T>(std::move(fn), scheduling::SCHED_IMMED) {}
+
+  void task_wait() override { this->wait(); }
+
+  bool task_done() noexcept override { return this->done(); }
+
+  PyObject *task_value() override { return to_python(this->get()); }
+};
+
+/**
+ * @brief fd_stream with the GIL released while blocked
+ */
+class py_stream : public fd_stream {
+public:
+  explicit py_stream(int fd) : fd_stream(fd) {}
+
+  PyObject *recv(size_t len) {
+    std::string buf(len, '\0');
+    size_t nn = 0;
+    {
+      gil_release nogil;
+      nn = read_some(buf.data(), len);
+    }
+    return PyBytes_FromStringAndSize(buf.data(),
+                                     static_cast<Py_ssize_t>(nn));
+  }
+
+  void send(const Py_buffer &data) {
+    gil_release nogil;
+    write(data.buf, static_cast<size_t>(data.len));
+  }
+};
+
+/**
+ * @brief listening socket, accepting connections without blocking the
+ * thread
+ */
+class py_listener : public fd_stream {
+public:
+  explicit py_listener(int fd) : fd_stream(fd) {}
+
+  std::shared_ptr<py_stream> accept() {
+    int conn = -1;
+    {
+      gil_release nogil;
+      while ((conn = ::accept4(fd(), nullptr, nullptr, SOCK_CLOEXEC)) < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          wait_io(POLLIN);
+        } else if (errno != EINTR && errno != ECONNABORTED) {
+          throw std::system_error(errno, std::generic_category(), "accept");
+        }
+      }
+    }
+    return std::make_shared<py_stream>(conn);
+  }
+};
+
+/// echo the stream until end of file, returning the number of bytes echoed
+inline size_t echo_stream(py_stream &stream) {
+  char buf[16384];
+  size_t total = 0;
+  try {
+    size_t nn = 0;
+    while ((nn = stream.read_some(buf, sizeof(buf))) > 0) {
+      stream.write(buf, nn);
+      total += nn;
+    }
+  } catch (const std::system_error &) {
+    // e.g connection reset by the peer
+  }
+  return total;
+}
+
+//
+// Python types
+//
+
+/// Python object holding a shared native object
+template <typename T> struct ptr_object {
+  PyObject_HEAD
+  std::shared_ptr<T> ptr;
+};
+
+static PyTypeObject *task_type = nullptr;
+static PyTypeObject *stream_type = nullptr;
+static PyTypeObject *listener_type = nullptr;
+
+/// a new Python object of `type` for `ptr`
+template <typename T>
+static PyObject *wrap(PyTypeObject *type, std::shared_ptr<T> ptr) {
+  PyObject *self = type->tp_alloc(type, 0);
+  if (!self) {
+    throw py_error_set();
+  }
+  new (&reinterpret_cast<ptr_object<T> *>(self)->ptr)
+      std::shared_ptr<T>(std::move(ptr));
+  return self;
+}
+
+/// the native object for `self`
+template <typename T> static T &unwrap(PyObject *self) {
+  T *ptr = reinterpret_cast<ptr_object<T> *>(self)->ptr.get();
+  if (!ptr) {
+    PyErr_SetString(PyExc_ValueError, "object is not initialized");
+    throw py_error_set();
+  }
+  return *ptr;
+}
+
+template <typename T> static void ptr_dealloc(PyObject *self) {
+  PyTypeObject *type = Py_TYPE(self);
+  reinterpret_cast<ptr_object<T> *>(self)->ptr.~shared_ptr<T>();
+  type->tp_free(self);
+  Py_DECREF(type);
+}
+
+/// a new Python object of `type` for a native object constructed from `fd`
+template <typename T>
+static PyObject *fd_object_new(PyTypeObject *type, PyObject *args,
+                               PyObject *kwds) {
+  static const char *kwlist[] = {"fd", nullptr};
+  int fd = -1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "i",
+                                   const_cast<char **>(kwlist), &fd)) {
+    return nullptr;
+  }
+  return py_call([type, fd]() { return wrap(type, std::make_shared<T>(fd)); });
+}
+
+/// `PyCFunction` for a function also accepting keyword arguments
+template <typename F> static PyCFunction as_cfunction(F *fn) noexcept {
+  return reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(fn));
+}
+
+//
+// Task
+//
+
+static PyObject *task_obj_get(PyObject *self, PyObject *) {
+  return py_call([self]() {
+    task_base &task = unwrap<task_base>(self);
+    {
+      gil_release nogil;
+      task.task_wait();
+    }
+    PyObject *value = task.task_value();
+    if (!value) {
+      throw py_error_set();
+    }
+    return value;
+  });
+}
+
+static PyObject *task_obj_wait(PyObject *self, PyObject *) {
+  return py_call([self]() {
+    task_base &task = unwrap<task_base>(self);
+    {
+      gil_release nogil;
+      task.task_wait();
+    }
+    Py_RETURN_NONE;
+  });
+}
+
+static PyObject *task_obj_done(PyObject *self, PyObject *) {
+  return py_call(
+      [self]() { return PyBool_FromLong(unwrap<task_base>(self).task_done()); });
+}
+
+static PyMethodDef task_methods[] = {
+    {"get", task_obj_get, METH_NOARGS,
+     "wait for the task, returning its value or raising its exception"},
+    {"wait", task_obj_wait, METH_NOARGS,
+     "wait for the task, running other fibers on this thread"},
+    {"done", task_obj_done, METH_NOARGS, "true if the task has completed"},
+    {nullptr, nullptr, 0, nullptr}};
+
+static PyType_Slot task_slots[] = {
+    {Py_tp_doc, const_cast<char *>("event for a task running on a fiber")},
+    {Py_tp_dealloc, reinterpret_cast<void *>(ptr_dealloc<task_base>)},
+    {Py_tp_methods, task_methods},
+    {0, nullptr}};
+
+static PyType_Spec task_spec = {
+    "evtlet.Task", sizeof(ptr_object<task_base>), 0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION, task_slots};
+
+/// a new Task object for `task`, held by the registry until complete
+static PyObject *task_object(std::shared_ptr<task_base> task) {
+  task_registry::instance().hold(task);
+  return wrap(task_type, std::move(task));
+}
+
+//
+// Stream
+//
+
+static PyObject *stream_obj_fileno(PyObject *self, PyObject *) {
+  return py_call(
+      [self]() { return PyLong_FromLong(unwrap<py_stream>(self).fd()); });
+}
+
+static PyObject *stream_obj_recv(PyObject *self, PyObject *args,
+                             PyObject *kwds) {
+  static const char *kwlist[] = {"len", nullptr};
+  Py_ssize_t len = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n",
+                                   const_cast<char **>(kwlist), &len)) {
+    return nullptr;
+  }
+  return py_call([self, len]() {
+    return unwrap<py_stream>(self).recv(
+        static_cast<size_t>(std::max<Py_ssize_t>(len, 0)));
+  });
+}
+
+static PyObject *stream_obj_send(PyObject *self, PyObject *args,
+                             PyObject *kwds) {
+  static const char *kwlist[] = {"data", nullptr};
+  Py_buffer data;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "y*",
+                                   const_cast<char **>(kwlist), &data)) {
+    return nullptr;
+  }
+  PyObject *result = py_call([self, &data]() {
+    unwrap<py_stream>(self).send(data);
+    Py_RETURN_NONE;
+  });
+  PyBuffer_Release(&data);
+  return result;
+}
+
+static PyObject *stream_obj_close(PyObject *self, PyObject *) {
+  return py_call([self]() {
+    unwrap<py_stream>(self).close();
+    Py_RETURN_NONE;
+  });
+}
+
+static PyMethodDef stream_methods[] = {
+    {"fileno", stream_obj_fileno, METH_NOARGS, "the file descriptor"},
+    {"recv", as_cfunction(stream_obj_recv), METH_VARARGS | METH_KEYWORDS,
+     "read at most len bytes, returning b'' at end of file"},
+    {"send", as_cfunction(stream_obj_send), METH_VARARGS | METH_KEYWORDS,
+     "write all of data"},
+    {"close", stream_obj_close, METH_NOARGS, "close the file descriptor"},
+    {nullptr, nullptr, 0, nullptr}};
+
+static PyType_Slot stream_slots[] = {
+    {Py_tp_doc, const_cast<char *>(
+                    "stream onto a file descriptor, e.g from socket.detach()")},
+    {Py_tp_new, reinterpret_cast<void *>(fd_object_new<py_stream>)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(ptr_dealloc<py_stream>)},
+    {Py_tp_methods, stream_methods},
+    {0, nullptr}};
+
+static PyType_Spec stream_spec = {"evtlet.Stream",
+                                  sizeof(ptr_object<py_stream>), 0,
+                                  Py_TPFLAGS_DEFAULT, stream_slots};
+
+//
+// Listener
+//
+
+static PyObject *listener_obj_fileno(PyObject *self, PyObject *) {
+  return py_call(
+      [self]() { return PyLong_FromLong(unwrap<py_listener>(self).fd()); });
+}
+
+static PyObject *listener_obj_accept(PyObject *self, PyObject *) {
+  return py_call([self]() {
+    return wrap(stream_type, unwrap<py_listener>(self).accept());
+  });
+}
+
+static PyObject *listener_obj_close(PyObject *self, PyObject *) {
+  return py_call([self]() {
+    unwrap<py_listener>(self).close();
+    Py_RETURN_NONE;
+  });
+}
+
+static PyMethodDef listener_methods[] = {
+    {"fileno", listener_obj_fileno, METH_NOARGS, "the file descriptor"},
+    {"accept", listener_obj_accept, METH_NOARGS,
+     "accept a connection as a Stream"},
+    {"close", listener_obj_close, METH_NOARGS, "close the file descriptor"},
+    {nullptr, nullptr, 0, nullptr}};
+
+static PyType_Slot listener_slots[] = {
+    {Py_tp_doc,
+     const_cast<char *>("listening socket, e.g from socket.detach()")},
+    {Py_tp_new, reinterpret_cast<void *>(fd_object_new<py_listener>)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(ptr_dealloc<py_listener>)},
+    {Py_tp_methods, listener_methods},
+    {0, nullptr}};
+
+static PyType_Spec listener_spec = {"evtlet.Listener",
+                                    sizeof(ptr_object<py_listener>), 0,
+                                    Py_TPFLAGS_DEFAULT, listener_slots};
+
+//
+// module functions
+//
+
+static PyObject *module_spawn(PyObject *, PyObject *args, PyObject *kwds) {
+  const Py_ssize_t nargs = PyTuple_GET_SIZE(args);
+  if (nargs < 1) {
+    PyErr_SetString(PyExc_TypeError, "spawn() missing argument: 'fn'");
+    return nullptr;
+  }
+  return py_call([args, kwds, nargs]() {
+    py_ref fn = py_ref::borrow(PyTuple_GET_ITEM(args, 0));
+    py_ref fn_args(PyTuple_GetSlice(args, 1, nargs));
+    if (!fn_args) {
+      throw py_error_set();
+    }
+    auto task = std::make_shared<py_task>(std::move(fn), std::move(fn_args),
+                                          py_ref::borrow(kwds));
+    return task_object(std::move(task));
+  });
+}
+
+static PyObject *module_echo(PyObject *, PyObject *args, PyObject *kwds) {
+  static const char *kwlist[] = {"stream", nullptr};
+  PyObject *obj = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!",
+                                   const_cast<char **>(kwlist), stream_type,
+                                   &obj)) {
+    return nullptr;
+  }
+  return py_call([obj]() {
+    std::shared_ptr<py_stream> stream =
+        reinterpret_cast<ptr_object<py_stream> *>(obj)->ptr;
+    return task_object(std::make_shared<native_task<size_t>>(
+        [stream]() { return echo_stream(*stream); }));
+  });
+}
+
+static PyObject *module_sleep(PyObject *, PyObject *args, PyObject *kwds) {
+  static const char *kwlist[] = {"seconds", nullptr};
+  double seconds = 0.;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|d",
+                                   const_cast<char **>(kwlist), &seconds)) {
+    return nullptr;
+  }
+  return py_call([seconds]() {
+    task_registry::instance().reap();
+    {
+      gil_release nogil;
+      if (seconds > 0) {
+        boost::this_fiber::sleep_for(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::duration<double>(seconds)));
+      } else {
+        boost::this_fiber::yield();
+      }
+    }
+    Py_RETURN_NONE;
+  });
+}
+
+static PyObject *module_joinall(PyObject *, PyObject *args, PyObject *kwds) {
+  static const char *kwlist[] = {"tasks", nullptr};
+  PyObject *obj = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O",
+                                   const_cast<char **>(kwlist), &obj)) {
+    return nullptr;
+  }
+  return py_call([obj]() {
+    py_ref seq(PySequence_Fast(obj, "tasks must be a sequence"));
+    if (!seq) {
+      throw py_error_set();
+    }
+    const Py_ssize_t nn = PySequence_Fast_GET_SIZE(seq.get());
+    std::vector<std::shared_ptr<task_base>> tasks;
+    tasks.reserve(static_cast<size_t>(nn));
+    for (Py_ssize_t ii = 0; ii < nn; ++ii) {
+      PyObject *item = PySequence_Fast_GET_ITEM(seq.get(), ii);
+      if (!PyObject_TypeCheck(item, task_type)) {
+        PyErr_SetString(PyExc_TypeError, "tasks must contain only Task");
+        throw py_error_set();
+      }
+      tasks.push_back(reinterpret_cast<ptr_object<task_base> *>(item)->ptr);
+    }
+    {
+      gil_release nogil;
+      for (auto &task : tasks) {
+        task->task_wait();
+      }
+    }
+    task_registry::instance().reap();
+    Py_RETURN_NONE;
+  });
+}
+
+static PyObject *module_pending(PyObject *, PyObject *) {
+  return py_call([]() {
+    task_registry::instance().reap();
+    return PyLong_FromSize_t(task_registry::instance().size());
+  });
+}
+
+static PyObject *module_set_stack_size(PyObject *, PyObject *args, PyObject *kwds) {
+  static const char *kwlist[] = {"size", nullptr};
+  Py_ssize_t size = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n",
+                                   const_cast<char **>(kwlist), &size)) {
+    return nullptr;
+  }
+  if (size <= 0) {
+    PyErr_SetString(PyExc_ValueError, "size must be positive");
+    return nullptr;
+  }
+  py_stack_size.store(static_cast<size_t>(size), std::memory_order_relaxed);
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef module_methods[] = {
+    {"spawn", as_cfunction(module_spawn), METH_VARARGS | METH_KEYWORDS,
+     "spawn(fn, *args, **kwargs)\n"
+     "run fn(*args, **kwargs) on a new fiber, on this thread"},
+    {"echo", as_cfunction(module_echo), METH_VARARGS | METH_KEYWORDS,
+     "echo the stream until end of file, on a fiber without the GIL"},
+    {"sleep", as_cfunction(module_sleep), METH_VARARGS | METH_KEYWORDS,
+     "suspend the calling fiber, or yield to other fibers if seconds is 0"},
+    {"joinall", as_cfunction(module_joinall), METH_VARARGS | METH_KEYWORDS,
+     "wait for each task, without raising its exception"},
+    {"pending", module_pending, METH_NOARGS,
+     "number of tasks on this thread not yet complete"},
+    {"set_stack_size", as_cfunction(module_set_stack_size),
+     METH_VARARGS | METH_KEYWORDS,
+     "stack size for fibers of later spawn() calls"},
+    {nullptr, nullptr, 0, nullptr}};
+
+static PyModuleDef module_def = {PyModuleDef_HEAD_INIT,
+                                 "evtlet",
+                                 "evtlet events and fiber-blocking I/O",
+                                 -1,
+                                 module_methods,
+                                 nullptr,
+                                 nullptr,
+                                 nullptr,
+                                 nullptr};
+
+/// create `type` from `spec`, adding it to `module`
+static PyTypeObject *add_type(PyObject *module, const char *name,
+                              PyType_Spec *spec) {
+  PyObject *type = PyType_FromSpec(spec);
+  if (!type) {
+    return nullptr;
+  }
+  if (PyModule_AddObjectRef(module, name, type) < 0) {
+    Py_DECREF(type);
+    return nullptr;
+  }
+  // a reference is held for the module's lifetime
+  return reinterpret_cast<PyTypeObject *>(type);
+}
+
+} // namespace python
+} // namespace evtlet
+
+PyMODINIT_FUNC PyInit_evtlet() {
+  using namespace evtlet::python;
+  PyObject *module = PyModule_Create(&module_def);
+  if (!module) {
+    return nullptr;
+  }
+  if (!(task_type = add_type(module, "Task", &task_spec)) ||
+      !(stream_type = add_type(module, "Stream", &stream_spec)) ||
+      !(listener_type = add_type(module, "Listener", &listener_spec))) {
+    Py_DECREF(module);
+    return nullptr;
+  }
+  return module;
+}
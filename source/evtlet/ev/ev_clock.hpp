@@ -0,0 +1,64 @@
+/**
+ * @file ev_clock.hpp
+ * @brief per-iteration update for evtlet::clock, within a libev loop
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <ev.h>
+
+#include <evtlet/util/clock.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief cached `evtlet::clock` time for a thread running a libev loop
+ *
+ * An `ev_check` watcher will update the cached time once per loop
+ * iteration, after the loop has polled for events. The watcher has the
+ * maximum priority, such that it will run before the callbacks for any
+ * other watcher of that iteration. Every call to `evtlet::clock::now()`
+ * within those callbacks, and within fibers resumed by them, will return
+ * that time.
+ *
+ * `ev_now()` is not used for the cache, as it is derived from the realtime
+ * clock. The monotonic clock will be read once per iteration instead.
+ *
+ * The watcher will not keep the loop alive. This must be created and
+ * destroyed on the thread running the loop.
+ */
+class ev_clock {
+private:
+  struct ev_loop *const m_loop;
+  ev_check m_check;
+  clock_cache_scope m_scope;
+
+  static void on_check(EV_P_ ev_check *, int) { clock::update(); }
+
+public:
+  explicit ev_clock(struct ev_loop *loop)
+      : m_loop(loop), m_check(), m_scope() {
+    ev_check_init(&m_check, on_check);
+    ev_set_priority(&m_check, EV_MAXPRI);
+    ev_check_start(m_loop, &m_check);
+    ev_unref(m_loop);
+  }
+
+  ~ev_clock() {
+    ev_ref(m_loop);
+    ev_check_stop(m_loop, &m_check);
+  }
+
+  /// not copyable
+  ev_clock(ev_clock const &) = delete;
+
+  /// not assignable
+  ev_clock &operator=(ev_clock const &) = delete;
+
+  struct ev_loop *loop() const noexcept { return m_loop; }
+};
+
+} // namespace evtlet
@@ -0,0 +1,247 @@
+/**
+ * @file ev_loop_fiber.hpp
+ * @brief fiber running a libev loop, alongside other fibers on a thread
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include <ev.h>
+
+#include <boost/fiber/algo/round_robin.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief round-robin scheduler algorithm, blocking the thread within a
+ * libev loop
+ *
+ * When no fiber is ready, the thread will block within the loop until
+ * some watcher is invoked, until the earliest deadline for the thread's
+ * fibers, e.g for `boost::this_fiber::sleep_for()`, or until a fiber is
+ * woken from another thread. An `ev_async` watcher will be signaled for
+ * the latter.
+ *
+ * Watcher callbacks are not invoked while the thread is blocked. Those
+ * will be invoked by the thread's `ev_loop_fiber`, which will resume
+ * once the thread has been woken.
+ *
+ * Install with `boost::fibers::use_scheduling_algorithm<ev_loop_algo>()`,
+ * for a loop that will not be run elsewhere.
+ */
+class ev_loop_algo : public boost::fibers::algo::round_robin {
+public:
+  using context_t = boost::fibers::context;
+
+private:
+  struct ev_loop *const m_loop;
+  ev_async m_wake;
+  ev_timer m_block;
+  context_t *m_parked;
+
+  static ev_loop_algo *&_current() noexcept {
+    static thread_local ev_loop_algo *algo = nullptr;
+    return algo;
+  }
+
+  static void on_wake(EV_P_ ev_async *, int) {}
+
+  static void on_block(EV_P_ ev_timer *, int) {}
+
+  // callbacks are deferred to the loop fiber
+  static void on_pending(EV_P) {}
+
+public:
+  explicit ev_loop_algo(struct ev_loop *loop)
+      : m_loop(loop), m_wake(), m_block(), m_parked(nullptr) {
+    ev_async_init(&m_wake, on_wake);
+    ev_async_start(m_loop, &m_wake);
+    ev_unref(m_loop);
+    ev_timer_init(&m_block, on_block, 0., 0.);
+    _current() = this;
+  }
+
+  virtual ~ev_loop_algo() {
+    _current() = nullptr;
+    ev_ref(m_loop);
+    ev_async_stop(m_loop, &m_wake);
+  }
+
+  /// not copyable
+  ev_loop_algo(ev_loop_algo const &) = delete;
+
+  /// not assignable
+  ev_loop_algo &operator=(ev_loop_algo const &) = delete;
+
+  /// the algorithm for the calling thread, or nullptr
+  static ev_loop_algo *current() noexcept { return _current(); }
+
+  struct ev_loop *loop() const noexcept { return m_loop; }
+
+  /// suspend the calling fiber, until the thread has next blocked
+  void park() {
+    m_parked = context_t::active();
+    m_parked->suspend();
+  }
+
+  /// resume the fiber suspended in `park()`, if any
+  void unpark() noexcept {
+    if (m_parked) {
+      context_t *ctx = m_parked;
+      m_parked = nullptr;
+      context_t::active()->schedule(ctx);
+    }
+  }
+
+  context_t *pick_next() noexcept override {
+    if (m_parked && round_robin::has_ready_fibers()) {
+      // the loop will be polled once for each round of ready fibers
+      unpark();
+    }
+    return round_robin::pick_next();
+  }
+
+  void suspend_until(
+      std::chrono::steady_clock::time_point const &abs_time) noexcept override {
+    const bool bounded =
+        (std::chrono::steady_clock::time_point::max)() != abs_time;
+    if (bounded) {
+      const auto now = std::chrono::steady_clock::now();
+      ev_now_update(m_loop);
+      ev_timer_set(&m_block,
+                   abs_time > now ? std::chrono::duration<ev_tstamp>(
+                                        abs_time - now)
+                                        .count()
+                                  : 0.,
+                   0.);
+      ev_timer_start(m_loop, &m_block);
+    }
+    // the async watcher will keep the loop alive while blocked
+    ev_ref(m_loop);
+    ev_set_invoke_pending_cb(m_loop, on_pending);
+    ev_run(m_loop, EVRUN_ONCE);
+    ev_set_invoke_pending_cb(m_loop, ev_invoke_pending);
+    ev_unref(m_loop);
+    if (bounded) {
+      ev_timer_stop(m_loop, &m_block);
+    }
+    unpark();
+  }
+
+  void notify() noexcept override { ev_async_send(m_loop, &m_wake); }
+};
+
+/**
+ * @brief fiber running a libev loop, for watcher callbacks on the thread's
+ * fibers
+ *
+ * While other fibers on the thread are ready, the loop will be polled
+ * without waiting, once for each time the loop fiber is scheduled.
+ *
+ * Otherwise, with an `ev_loop_algo` for the loop on the thread, the loop
+ * fiber will suspend while the scheduler blocks the thread within the
+ * loop, bounded by the earliest deadline for the thread's fibers and
+ * woken for fibers made ready from other threads. The loop fiber will
+ * then invoke the callbacks for any watchers.
+ *
+ * With any other scheduler algorithm, the loop fiber will block the thread
+ * within the loop, until some watcher is invoked or `max_block` has
+ * elapsed. `max_block` then bounds the delay for fibers woken other than
+ * by the loop, e.g by `boost::this_fiber::sleep_for()` or from other
+ * threads. With `max_block` of `duration::max()`, the thread will wait
+ * only for loop events.
+ *
+ * Watcher callbacks run on the loop fiber, such that callbacks may notify
+ * fiber conditions and mutexes.
+ *
+ * This must be created and destroyed on the thread running the loop's
+ * watchers. The loop must not be run elsewhere, while the loop fiber is
+ * running.
+ */
+class ev_loop_fiber {
+public:
+  using duration = std::chrono::nanoseconds;
+
+private:
+  struct ev_loop *const m_loop;
+  const duration m_max_block;
+  ev_loop_algo *const m_algo;
+  ev_timer m_block;
+  bool m_stop;
+  boost::fibers::fiber m_fiber;
+
+  static void on_block(EV_P_ ev_timer *, int) {}
+
+  static ev_loop_algo *_algo_for(struct ev_loop *loop) noexcept {
+    ev_loop_algo *algo = ev_loop_algo::current();
+    return algo && algo->loop() == loop ? algo : nullptr;
+  }
+
+  void run() {
+    const bool bounded = m_max_block != duration::max();
+    while (!m_stop) {
+      if (boost::fibers::has_ready_fibers()) {
+        ev_run(m_loop, EVRUN_NOWAIT);
+      } else if (m_algo) {
+        m_algo->park();
+        ev_invoke_pending(m_loop);
+        continue;
+      } else if (bounded) {
+        ev_timer_set(&m_block,
+                     std::chrono::duration<ev_tstamp>(m_max_block).count(),
+                     0.);
+        ev_timer_start(m_loop, &m_block);
+        ev_run(m_loop, EVRUN_ONCE);
+        ev_timer_stop(m_loop, &m_block);
+      } else {
+        ev_run(m_loop, EVRUN_ONCE);
+      }
+      boost::this_fiber::yield();
+    }
+  }
+
+public:
+  explicit ev_loop_fiber(struct ev_loop *loop,
+                         duration max_block = std::chrono::milliseconds(10))
+      : m_loop(loop), m_max_block(max_block), m_algo(_algo_for(loop)),
+        m_block(), m_stop(false), m_fiber() {
+    ev_timer_init(&m_block, on_block, 0., 0.);
+    m_fiber = boost::fibers::fiber(&ev_loop_fiber::run, this);
+  }
+
+  ~ev_loop_fiber() { stop(); }
+
+  /// not copyable
+  ev_loop_fiber(ev_loop_fiber const &) = delete;
+
+  /// not assignable
+  ev_loop_fiber &operator=(ev_loop_fiber const &) = delete;
+
+  struct ev_loop *loop() const noexcept { return m_loop; }
+
+  /**
+   * @brief stop the loop fiber, then join it
+   *
+   * The loop fiber will stop after the current loop iteration, if any,
+   * and will be resumed if suspended under an `ev_loop_algo`. Watchers
+   * will not be stopped.
+   */
+  void stop() {
+    m_stop = true;
+    if (m_algo) {
+      m_algo->unpark();
+    }
+    if (m_fiber.joinable()) {
+      m_fiber.join();
+    }
+  }
+};
+
+} // namespace evtlet
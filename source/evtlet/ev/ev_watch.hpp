@@ -0,0 +1,252 @@
+/**
+ * @file ev_watch.hpp
+ * @brief libev signal, child process and file status watchers, as events
+ * for fibers
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <sys/types.h>
+
+#include <ev.h>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/evt/evt_state.hpp>
+#include <evtlet/util/optional_source.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief evt_fiber completing with the first event for a libev watcher
+ *
+ * The watcher is started on construction, such that an event will not be
+ * missed before the event is waited. The watcher's callback will publish
+ * the watcher's value directly as the event's value, such that no fiber
+ * is dispatched for the event. An event may be destroyed before the
+ * watcher is invoked, stopping the watcher.
+ *
+ * Watcher callbacks are invoked from the loop, typically on an
+ * `ev_loop_fiber`. Instances must be created and destroyed on the thread
+ * running the loop.
+ *
+ * @tparam T value type for the event
+ * @tparam watcher_t libev watcher type
+ */
+template <typename T, typename watcher_t>
+class ev_watch_evt : public evt_fiber<T> {
+public:
+  using fiber_t = typename evt_fiber<T>::fiber_t;
+
+protected:
+  struct ev_loop *const m_loop;
+  watcher_t m_watcher;
+
+public:
+  explicit ev_watch_evt(struct ev_loop *loop)
+      : evt_fiber<T>(scheduling::SCHED_DEFER), m_loop(loop), m_watcher() {
+    // pending from construction, for the watcher
+    this->_set_state(evt_state::STATE_PENDING);
+  }
+
+  struct ev_loop *loop() const noexcept { return m_loop; }
+
+  /// true if the watcher has not yet been invoked
+  bool active() const noexcept { return ev_is_active(&m_watcher); }
+
+  virtual T &get() {
+    this->wait();
+    return evt_fiber<T>::get();
+  }
+
+  /// no fiber is used for the event, which is completed by the watcher
+  virtual fiber_t *ensure_fiber(bool = false) { return nullptr; }
+
+protected:
+  /// stop the watcher. Called from the watcher's callback
+  virtual void _stop() = 0;
+
+  /// complete the event with `value`, from the watcher's callback
+  void _complete(T value) {
+    _stop();
+    this->_acquire_cv_lock();
+    this->_set_value(std::move(value));
+    this->cv_notify();
+    this->_release_cv_lock();
+    this->_set_state(evt_state::STATE_DONE);
+  }
+
+  virtual T func() { return get(); }
+};
+
+/**
+ * @brief event for the next delivery of a signal, with the signal number
+ *
+ * A signal may be watched by only one loop at a time. Unless libev uses
+ * `signalfd`, the signal should be watched with the default loop.
+ */
+class ev_signal_evt : public ev_watch_evt<int, ev_signal> {
+private:
+  static void on_signal(EV_P_ ev_signal *w, int) {
+    static_cast<ev_signal_evt *>(w->data)->_complete(w->signum);
+  }
+
+public:
+  ev_signal_evt(struct ev_loop *loop, int signum)
+      : ev_watch_evt<int, ev_signal>(loop) {
+    ev_signal_init(&m_watcher, on_signal, signum);
+    m_watcher.data = this;
+    ev_signal_start(m_loop, &m_watcher);
+  }
+
+  virtual ~ev_signal_evt() { _stop(); }
+
+  int signum() const noexcept { return m_watcher.signum; }
+
+protected:
+  virtual void _stop() { ev_signal_stop(m_loop, &m_watcher); }
+};
+
+/**
+ * @brief event for the exit of a child process, with the process' wait
+ * status
+ *
+ * The value may be decoded with e.g `WIFEXITED()` and `WEXITSTATUS()`.
+ * libev will watch child processes only with the default loop. A child
+ * process may be watched after it has exited, until the loop next
+ * handles `SIGCHLD`.
+ */
+class ev_child_evt : public ev_watch_evt<int, ev_child> {
+private:
+  static void on_child(EV_P_ ev_child *w, int) {
+    static_cast<ev_child_evt *>(w->data)->_complete(w->rstatus);
+  }
+
+public:
+  ev_child_evt(struct ev_loop *loop, pid_t pid)
+      : ev_watch_evt<int, ev_child>(loop) {
+    ev_child_init(&m_watcher, on_child, pid, 0);
+    m_watcher.data = this;
+    ev_child_start(m_loop, &m_watcher);
+  }
+
+  virtual ~ev_child_evt() { _stop(); }
+
+  pid_t pid() const noexcept { return m_watcher.pid; }
+
+protected:
+  virtual void _stop() { ev_child_stop(m_loop, &m_watcher); }
+};
+
+/// change in file status, for an `ev_stat_stream`
+struct stat_change {
+  /// status before the change
+  ev_statdata prev;
+  /// status after the change. `st_nlink` will be zero, if the path does
+  /// not exist
+  ev_statdata attr;
+};
+
+/**
+ * @brief stream of status changes for a file path
+ *
+ * Changes are queued as they are reported by the watcher, until received
+ * with `next()`. libev will use inotify where available, else polling
+ * at `interval` seconds, or a libev default for zero.
+ *
+ * Instances must be created and destroyed on the thread running the loop.
+ */
+class ev_stat_stream {
+private:
+  struct ev_loop *const m_loop;
+  const std::string m_path;
+  ev_stat m_watcher;
+  boost::fibers::mutex m_mtx;
+  boost::fibers::condition_variable m_cnd;
+  std::deque<stat_change> m_changes;
+  bool m_closed;
+
+  static void on_stat(EV_P_ ev_stat *w, int) {
+    auto *stream = static_cast<ev_stat_stream *>(w->data);
+    std::unique_lock<boost::fibers::mutex> lck(stream->m_mtx);
+    stream->m_changes.push_back(stat_change{w->prev, w->attr});
+    stream->m_cnd.notify_all();
+  }
+
+public:
+  ev_stat_stream(struct ev_loop *loop, std::string path,
+                 ev_tstamp interval = 0.)
+      : m_loop(loop), m_path(std::move(path)), m_watcher(), m_mtx(),
+        m_cnd(), m_changes(), m_closed(false) {
+    ev_stat_init(&m_watcher, on_stat, m_path.c_str(), interval);
+    m_watcher.data = this;
+    ev_stat_start(m_loop, &m_watcher);
+  }
+
+  ~ev_stat_stream() { ev_stat_stop(m_loop, &m_watcher); }
+
+  /// not copyable
+  ev_stat_stream(ev_stat_stream const &) = delete;
+
+  /// not assignable
+  ev_stat_stream &operator=(ev_stat_stream const &) = delete;
+
+  const std::string &path() const noexcept { return m_path; }
+
+  /// the latest status for the path
+  const ev_statdata &attr() const noexcept { return m_watcher.attr; }
+
+  /**
+   * @brief wait for the next change, blocking only the calling fiber
+   *
+   * @return the change, or NULLOPT once the stream is closed and no
+   *         change remains queued
+   */
+  OPTIONAL_T<stat_change> next() {
+    std::unique_lock<boost::fibers::mutex> lck(m_mtx);
+    while (m_changes.empty() && !m_closed) {
+      m_cnd.wait(lck);
+    }
+    return _pop();
+  }
+
+  /// the next change if one is queued, else NULLOPT
+  OPTIONAL_T<stat_change> try_next() {
+    std::unique_lock<boost::fibers::mutex> lck(m_mtx);
+    return _pop();
+  }
+
+  /**
+   * @brief stop watching the path, and wake each fiber waiting on `next()`
+   *
+   * Queued changes will remain available.
+   */
+  void close() {
+    ev_stat_stop(m_loop, &m_watcher);
+    std::unique_lock<boost::fibers::mutex> lck(m_mtx);
+    m_closed = true;
+    m_cnd.notify_all();
+  }
+
+private:
+  OPTIONAL_T<stat_change> _pop() {
+    if (m_changes.empty()) {
+      return NULLOPT;
+    }
+    stat_change change = m_changes.front();
+    m_changes.pop_front();
+    return change;
+  }
+};
+
+} // namespace evtlet
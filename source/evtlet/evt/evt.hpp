@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <typeinfo>
 
 namespace evtlet {
 
@@ -20,6 +21,9 @@ public:
   virtual T &get() = 0;
   virtual bool done() noexcept = 0;
 
+  /// identity for the event type, e.g for stall reports and stack profiles
+  virtual const char *evt_tag() const noexcept { return typeid(*this).name(); }
+
 protected:
   virtual T func() = 0;
 
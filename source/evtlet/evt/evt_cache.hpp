@@ -0,0 +1,208 @@
+/**
+ * @file evt_cache.hpp
+ * @brief keyed registry of shared events, for request coalescing
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <evtlet/evt/evt_call.hpp>
+#include <evtlet/util/clock.hpp>
+#include <evtlet/util/optional_source.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief single-flight registry of events by key
+ *
+ * `get_or_spawn(key, fn)` returns the pending or completed event for
+ * `key`, if any. Otherwise, a new event will be dispatched for `fn`. Thus,
+ * concurrent callers for one key will share a single call to `fn`, each
+ * waiting on the same event with `get()`.
+ *
+ * A completed event will be retained for at most `ttl` after completion,
+ * and at most `max_completed` completed events will be retained, evicting
+ * the oldest first. Pending events are never evicted. An event completing
+ * with an exception is not retained, such that a later caller will retry.
+ *
+ * The registry may be shared across threads.
+ *
+ * @tparam K key type
+ * @tparam T value type for each event
+ * @tparam Clock clock for completion times. With the default clock, the
+ *         TTL will be measured with the loop-cached or coarse time.
+ * @tparam Hash hash function for keys
+ */
+template <typename K, typename T, typename Clock = evtlet::clock,
+          typename Hash = std::hash<K>>
+class evt_cache {
+public:
+  using key_t = K;
+  using value_t = T;
+  using duration_t = typename Clock::duration;
+  using time_point_t = typename Clock::time_point;
+  class cache_evt;
+  using evt_t = cache_evt;
+  using evt_ptr = std::shared_ptr<evt_t>;
+
+private:
+  struct entry {
+    evt_ptr evt;
+    size_t gen;
+    OPTIONAL_T<time_point_t> done_at;
+    typename std::list<key_t>::iterator lru;
+  };
+
+  /// shared state, referenced weakly by pending events
+  struct state {
+    // a thread lock, never held while a fiber may be suspended
+    std::mutex lock;
+    std::unordered_map<key_t, entry, Hash> entries;
+    // keys for completed events, oldest first
+    std::list<key_t> completed;
+    size_t gen;
+    const duration_t ttl;
+    const size_t max_completed;
+
+    state(duration_t tt, size_t mm)
+        : lock(), entries(), completed(), gen(0), ttl(tt),
+          max_completed(mm) {}
+
+    void evict(typename std::unordered_map<key_t, entry, Hash>::iterator it) {
+      if (it->second.done_at.has_value()) {
+        completed.erase(it->second.lru);
+      }
+      entries.erase(it);
+    }
+
+    void purge_expired(time_point_t now) {
+      while (!completed.empty()) {
+        auto it = entries.find(completed.front());
+        if (it->second.done_at.value() + ttl > now) {
+          break;
+        }
+        evict(it);
+      }
+    }
+
+    void mark_done(const key_t &key, size_t for_gen, bool failed) {
+      std::unique_lock<std::mutex> lck(lock);
+      auto it = entries.find(key);
+      if (it == entries.end() || it->second.gen != for_gen) {
+        // erased while pending
+        return;
+      } else if (failed) {
+        evict(it);
+        return;
+      }
+      it->second.done_at.emplace(Clock::now());
+      it->second.lru = completed.insert(completed.end(), key);
+      while (completed.size() > max_completed) {
+        evict(entries.find(completed.front()));
+      }
+    }
+  };
+
+  const std::shared_ptr<state> m_state;
+
+public:
+  /**
+   * @brief event for a call in the registry
+   *
+   * The event will hold a reference to itself from creation until its
+   * entry has been marked done, such that evicting or erasing the entry
+   * will not destroy the event under its fiber.
+   */
+  class cache_evt : public evt_call<T> {
+  private:
+    friend class evt_cache;
+
+    const std::weak_ptr<state> m_state;
+    const key_t m_key;
+    const size_t m_gen;
+    std::shared_ptr<cache_evt> m_self;
+
+  public:
+    cache_evt(typename evt_call<T>::func_t &&fn, std::weak_ptr<state> st,
+              key_t key, size_t gen)
+        : evt_call<T>(std::move(fn)), m_state(std::move(st)),
+          m_key(std::move(key)), m_gen(gen), m_self() {}
+
+  protected:
+    virtual void dispatch_func() {
+      const std::shared_ptr<cache_evt> self = std::move(m_self);
+      evt_call<T>::dispatch_func();
+      if (auto st = m_state.lock()) {
+        st->mark_done(m_key, m_gen, this->has_error());
+      }
+    }
+  };
+
+  explicit evt_cache(duration_t ttl, size_t max_completed = 1024)
+      : m_state(std::make_shared<state>(ttl, max_completed)) {}
+
+  /// not copyable
+  evt_cache(evt_cache const &) = delete;
+
+  /// not assignable
+  evt_cache &operator=(evt_cache const &) = delete;
+
+  /**
+   * @brief the event for `key`, dispatching a new event for `fn` if no
+   * event for `key` is pending or retained
+   */
+  template <typename F> evt_ptr get_or_spawn(const key_t &key, F &&fn) {
+    std::unique_lock<std::mutex> lck(m_state->lock);
+    m_state->purge_expired(Clock::now());
+    auto it = m_state->entries.find(key);
+    if (it != m_state->entries.end()) {
+      return it->second.evt;
+    }
+    const size_t gen = ++m_state->gen;
+    auto evt = std::make_shared<evt_t>(
+        typename evt_t::func_t(std::forward<F>(fn)), m_state, key, gen);
+    // released by the event's fiber, once the entry has been marked done
+    evt->m_self = evt;
+    m_state->entries.emplace(key, entry{evt, gen, NULLOPT, {}});
+    lck.unlock();
+    evt->dispatch_detached();
+    return evt;
+  }
+
+  /// the event for `key` if pending or retained, else nullptr
+  evt_ptr find(const key_t &key) {
+    std::unique_lock<std::mutex> lck(m_state->lock);
+    m_state->purge_expired(Clock::now());
+    auto it = m_state->entries.find(key);
+    return it == m_state->entries.end() ? nullptr : it->second.evt;
+  }
+
+  /// remove any event for `key`, without affecting holders of the event
+  void erase(const key_t &key) {
+    std::unique_lock<std::mutex> lck(m_state->lock);
+    auto it = m_state->entries.find(key);
+    if (it != m_state->entries.end()) {
+      m_state->evict(it);
+    }
+  }
+
+  /// number of pending and retained events
+  size_t size() {
+    std::unique_lock<std::mutex> lck(m_state->lock);
+    m_state->purge_expired(Clock::now());
+    return m_state->entries.size();
+  }
+};
+
+} // namespace evtlet
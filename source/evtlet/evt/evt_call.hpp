@@ -0,0 +1,45 @@
+/**
+ * @file evt_call.hpp
+ * @brief evt_fiber for a callable
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <utility>
+
+#include <evtlet/evt/evt_fiber.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief evt_fiber with an event function provided as a callable
+ *
+ * @tparam T return value type for the callable
+ */
+template <typename T> class evt_call : public evt_fiber<T> {
+public:
+  using func_t = std::function<T()>;
+
+private:
+  func_t m_func;
+
+public:
+  explicit evt_call(func_t &&fn, scheduling sched = scheduling::SCHED_DEFER)
+      : evt_fiber<T>(scheduling::SCHED_DEFER), m_func(std::move(fn)) {
+    // dispatched here rather than in the base constructor, such that the
+    // callable will have been initialized before the fiber is run
+    if (static_cast<size_t>(sched) &
+        static_cast<size_t>(scheduling::SCHED_IMMED)) {
+      this->dispatch_detached();
+    }
+  }
+
+protected:
+  virtual T func() { return m_func(); }
+};
+
+} // namespace evtlet
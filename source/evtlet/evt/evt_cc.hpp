@@ -6,6 +6,9 @@
 
 #include <evtlet/evt/evt.hpp>
 #include <evtlet/evt/evt_state.hpp>
+#ifdef EVTLET_STACK_PROFILE
+#include <evtlet/rt/stack_profile.hpp>
+#endif
 #include <evtlet/util/dbg.hpp>
 #include <evtlet/util/optional_source.hpp>
 #include <evtlet/util/scope_source.hpp>
@@ -91,7 +94,11 @@ protected:
       _release_cv_lock();
       locked = false;
       auto ff = std::bind(&evt_cc<T>::func_cc, this, _1);
+#ifdef EVTLET_STACK_PROFILE
+      ctx::callcc(std::allocator_arg, profiled_stack<>(this->evt_tag()), ff);
+#else
       ctx::callcc(ff);
+#endif
     } else {
       _release_cv_lock();
       locked = false;
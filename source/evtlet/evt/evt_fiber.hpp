@@ -11,18 +11,28 @@
 
 #pragma once
 
+#include <exception>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
 
+#include <boost/context/detail/config.hpp>
 #include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
 #include <boost/fiber/future/async.hpp>
 #include <boost/fiber/future/future.hpp>
 #include <boost/fiber/mutex.hpp>
 
 #include <evtlet/evt/evt.hpp>
+#include <evtlet/evt/evt_props.hpp>
 #include <evtlet/evt/evt_state.hpp>
+#ifdef EVTLET_STACK_PROFILE
+#include <evtlet/rt/stack_profile.hpp>
+#endif
+#include <evtlet/sync/spin_wait.hpp>
 #include <evtlet/util/dbg.hpp>
+#include <evtlet/util/mask.hpp>
 #include <evtlet/util/optional_source.hpp>
 #include <evtlet/util/scope_source.hpp>
 
@@ -37,20 +47,39 @@ enum class scheduling : size_t {
 /**
  * @brief prototype for an Event-oriented API onto boost fibers
  *
+ * The event state is held in an `atomic_mask`, such that `done()`,
+ * `has_value()`, `get_state()` and `get()` for a completed event will not
+ * lock. The event's value is published under the condition's lock, for
+ * waiters. `STATE_DONE` is set after the lock is released, as the last
+ * access to the event by its fiber, such that the event may be destroyed
+ * once `wait()` or `get()` has returned.
+ *
+ * An exception thrown by the event function is captured as the event's
+ * result, then rethrown to each caller of `get()`.
+ *
  * @tparam T return value type for the event function
+ * @tparam condition_lock_t fiber-aware lock type, e.g `adaptive_mutex`
+ * @tparam condition_t condition variable type, usable with a
+ *         `std::unique_lock<condition_lock_t>`. With a lock type other
+ *         than `boost::fibers::mutex`, this may be `adaptive_condition`
+ * @tparam stack_allocator_t stack allocator for the event's fiber, e.g
+ *         `numa_stack`
  */
 template <typename T, typename condition_lock_t = boost::fibers::mutex,
-          typename condition_t = boost::fibers::condition_variable>
+          typename condition_t = boost::fibers::condition_variable,
+          typename stack_allocator_t = boost::fibers::default_stack>
 class evt_fiber : public evt<T> {
 public:
   using fiber_t = boost::fibers::fiber;
+  using stack_t = stack_allocator_t;
   using fiber_id_t = fiber_t::id;
   using value_t = T;
 
 private:
   const scheduling m_sched;
-  OPTIONAL_T<evt_state> m_state;
+  atomic_mask<evt_state> m_state;
   OPTIONAL_T<value_t> m_value;
+  std::exception_ptr m_error;
   std::unique_ptr<fiber_t, std::function<void(fiber_t *)>> m_fiber;
 
   condition_lock_t m_cv_lock;
@@ -58,7 +87,8 @@ private:
 
 public:
   explicit evt_fiber(scheduling sched = scheduling::SCHED_DEFER)
-      : evt<T>(), m_sched(sched), m_state(), m_value(NULLOPT),
+      : evt<T>(), m_sched(sched), m_state(evt_state::STATE_NONE),
+        m_value(NULLOPT), m_error(),
         m_fiber(nullptr, _dealloc_fiber) {
     if (static_cast<size_t>(sched) &
         static_cast<size_t>(scheduling::SCHED_IMMED)) {
@@ -74,13 +104,22 @@ public:
   };
 
   virtual void wait() {
-    std::unique_lock<condition_lock_t> cv_lck(m_cv_lock);
-    while (!static_cast<bool>(m_value)) {
-      m_cond.wait(cv_lck);
+    if (done()) {
+      return;
+    }
+    {
+      std::unique_lock<condition_lock_t> cv_lck(m_cv_lock);
+      while (!_has_result()) {
+        m_cond.wait(cv_lck);
+      }
     }
+    _await_done();
   };
 
   virtual T &get() {
+    if (done()) {
+      return _result();
+    }
 
     m_cv_lock.lock();
     bool locked = true;
@@ -91,13 +130,14 @@ public:
       }
     }}; // guard
 
-    if (static_cast<bool>(m_value)) {
+    if (_has_result()) {
       m_cv_lock.unlock();
       locked = false;
-      return m_value.value();
+      _await_done();
+      return _result();
     } else {
       boost::fibers::fiber wait_fiber([this]() {
-        if (!static_cast<bool>(m_state)) {
+        if (m_state.load() == evt_state::STATE_NONE) {
           auto df = ensure_fiber();
           ASSERT(df);
           if (df->joinable()) {
@@ -112,7 +152,7 @@ public:
       m_cv_lock.unlock();
       locked = false;
       wait_fiber.join();
-      return m_value.value();
+      return _result();
     }
   };
 
@@ -123,14 +163,16 @@ public:
     }
   }
 
-  virtual void dispatch_detached() {
-    auto *ff = ensure_fiber();
-    if (ff && ff->joinable()) {
-      ff->detach();
-    }
-  }
+  virtual void dispatch_detached() { ensure_fiber(true); }
 
-  virtual fiber_t *ensure_fiber() {
+  /**
+   * @brief create the event's fiber, if the fiber has not been created
+   *
+   * @param detach if true, the fiber will be detached under the
+   *        condition's lock, before it can run on any thread
+   * @return the event's fiber, or nullptr if the event has a result
+   */
+  virtual fiber_t *ensure_fiber(bool detach = false) {
     // if m_fiber is null, then create a new fiber and store in m_fiber
     m_cv_lock.lock();
     bool locked = true;
@@ -140,28 +182,52 @@ public:
         locked = false;
       }
     }}; // guard
-    if (m_value.has_value()) {
+    if (_has_result()) {
       m_cv_lock.unlock();
       locked = false;
       return nullptr;
     } else if (!m_fiber) {
-      m_state.emplace(evt_state::STATE_PENDING);
+      m_state.fetch_or(evt_state::STATE_PENDING);
+      // the tag for the fiber's evt_props, under a scheduler algorithm
+      // using evt_props
+      evt_tag_scope tag_scope(this->evt_tag());
+#ifdef EVTLET_STACK_PROFILE
+      fiber_t *disp = new fiber_t(
+          std::allocator_arg,
+          profiled_stack<stack_t>(this->evt_tag(), _make_stack_allocator()),
+          std::bind(&evt_fiber::dispatch_func, this));
+#else
       fiber_t *disp =
-          new fiber_t(std::bind(&evt_fiber<T>::dispatch_func, this));
+          new fiber_t(std::allocator_arg, _make_stack_allocator(),
+                      std::bind(&evt_fiber::dispatch_func, this));
+#endif
       m_fiber.reset(std::move(disp));
     };
+    if (detach && m_fiber->joinable()) {
+      // dispatch_func() will detach the fiber under the same lock, if not
+      // detached here
+      m_fiber->detach();
+      m_state.fetch_or(evt_state::STATE_DETACHED);
+    }
+    // the event may be destroyed once the lock is released, if detached
+    fiber_t *ff = m_fiber.get();
     m_cv_lock.unlock();
     locked = false;
-    return m_fiber.get();
+    return ff;
   };
 
-  virtual bool done() noexcept { return static_cast<bool>(m_value); };
+  virtual bool done() noexcept {
+    return m_state.test(evt_state::STATE_DONE, std::memory_order_acquire);
+  };
 
   virtual bool fiber_pending() noexcept {
-    return static_cast<bool>(m_fiber) && !m_value.has_value();
+    return static_cast<bool>(m_fiber) && !done();
   }
 
-  virtual bool has_value() noexcept { return m_value.has_value(); }
+  virtual bool has_value() noexcept { return done() && !m_error; }
+
+  /// true if the event has completed with an exception
+  virtual bool has_error() noexcept { return done() && m_error; }
 
   virtual OPTIONAL_T<bool> get_detached_state() {
     m_cv_lock.lock();
@@ -193,14 +259,8 @@ public:
   }
 
   virtual evt_state get_state() {
-    m_cv_lock.lock();
-    SCOPE_EXIT guard{[this]() { m_cv_lock.unlock(); }};
-    return m_value.has_value() ? evt_state::STATE_DONE
-                               : (static_cast<bool>(m_fiber)
-                                      ? static_cast<bool>(m_fiber->get_id())
-                                            ? evt_state::STATE_PENDING
-                                            : evt_state::STATE_PENDING_DETACHED
-                                      : evt_state::STATE_NONE);
+    const evt_state st = m_state.load(std::memory_order_acquire);
+    return !!(st & evt_state::STATE_DONE) ? evt_state::STATE_DONE : st;
   }
 
 protected:
@@ -212,27 +272,74 @@ protected:
     delete fiber;
   }
 
+  /// stack allocator for the event's fiber, when the fiber is created
+  virtual stack_t _make_stack_allocator() { return stack_t(); }
+
   virtual void dispatch_func() {
-    ASSERT(!m_value.has_value());
-    auto vv = this->func();
-    _cv_prelock_acquire();
-    m_value.emplace(std::move(vv));
-    ASSERT(m_state != evt_state::STATE_DONE);
-    m_state.emplace(evt_state::STATE_DONE);
-    ASSERT(m_fiber);
-    if (m_fiber->joinable()) {
-      // detach the fiber before potential deletion
-      m_fiber->detach();
-    };
-    m_fiber.release();
-    m_cond.notify_all();
+    ASSERT(!done());
+    OPTIONAL_T<value_t> vv(NULLOPT);
+    std::exception_ptr err;
+    try {
+      vv.emplace(this->func());
+#if defined(BOOST_CONTEXT_HAS_CXXABI_H)
+    } catch (abi::__forced_unwind const &) {
+      // unwinding the fiber's stack
+      throw;
+#endif
+    } catch (...) {
+      err = std::current_exception();
+    }
+    {
+      // the result is published under the condition's lock, such that a
+      // waiter on some other thread cannot miss the notification
+      std::unique_lock<condition_lock_t> cv_lck(m_cv_lock);
+      _cv_prelock_acquire();
+      ASSERT(!_has_result());
+      if (err) {
+        m_error = std::move(err);
+      } else {
+        m_value.emplace(std::move(vv.value()));
+      }
+      ASSERT(m_fiber);
+      if (m_fiber->joinable()) {
+        // detach the fiber before potential deletion
+        m_fiber->detach();
+      };
+      m_fiber.release();
+      m_cond.notify_all();
+    }
+    // the last access to the event. A waiter observing STATE_DONE may
+    // destroy the event
+    m_state.fetch_or(evt_state::STATE_DONE, std::memory_order_release);
   };
 
-  // protected accessors for subclasses
-  virtual evt_state _get_state() {
-    return m_state.value_or(evt_state::STATE_NONE);
+  /**
+   * @brief wait for `STATE_DONE`, once the value has been published
+   *
+   * The event's fiber will set `STATE_DONE` directly after releasing the
+   * condition's lock, without switching. This will spin only while that
+   * fiber is running on some other thread.
+   */
+  void _await_done() {
+    while (!spin_until([this]() { return done(); }, default_spin_limit)) {
+      std::this_thread::yield();
+    }
   }
-  virtual void _set_state(evt_state st) { m_state.emplace(st); }
+
+  /// true if a value or exception has been published
+  bool _has_result() const noexcept { return m_value.has_value() || m_error; }
+
+  /// the published value, else rethrow the published exception
+  T &_result() {
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+    return m_value.value();
+  }
+
+  // protected accessors for subclasses
+  virtual evt_state _get_state() { return m_state.load(); }
+  virtual void _set_state(evt_state st) { m_state.store(st); }
 
   virtual void _set_value(T &&value) { m_value.emplace(value); }
 
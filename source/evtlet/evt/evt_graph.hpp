@@ -0,0 +1,207 @@
+/**
+ * @file evt_graph.hpp
+ * @brief static graphs of event functions, reusable across runs
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/rt/stack_pool.hpp>
+#include <evtlet/util/dbg.hpp>
+#include <evtlet/util/optional_source.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief directed acyclic graph of event functions
+ *
+ * Each node of the graph is a function of the values of the node's
+ * dependencies. Nodes are declared once with `add_node()`, and the graph
+ * may then be run any number of times. On each `run()`, every node will be
+ * launched as soon as all of its dependencies have completed, such that
+ * independent branches of the graph may run concurrently, e.g under a
+ * `worker_pool`.
+ *
+ * Node state and fiber stacks are retained across runs. Once the stack
+ * pool for the graph has been filled, a run will not allocate except
+ * within the node functions.
+ *
+ * A node function must not throw.
+ *
+ * @tparam T value type for every node
+ * @tparam stack_allocator_t upstream allocator for the graph's stack pool
+ */
+template <typename T,
+          typename stack_allocator_t = boost::fibers::fixedsize_stack>
+class evt_graph {
+public:
+  using value_t = T;
+  using node_id = size_t;
+  /// values of a node's dependencies, in the order declared
+  using inputs_t = std::span<const T *const>;
+  using func_t = std::function<T(inputs_t)>;
+  using pool_t = stack_pool<stack_allocator_t>;
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+
+private:
+  struct node {
+    func_t func;
+    std::vector<node_id> deps;
+    std::vector<node_id> dependents;
+    std::vector<const T *> inputs;
+    OPTIONAL_T<T> value;
+    std::atomic<size_t> pending;
+
+    node(func_t &&fn, std::vector<node_id> &&dd)
+        : func(std::move(fn)), deps(std::move(dd)), dependents(),
+          inputs(deps.size(), nullptr), value(NULLOPT), pending(0) {}
+  };
+
+  std::vector<std::unique_ptr<node>> m_nodes;
+  std::vector<node_id> m_roots;
+  const std::shared_ptr<pool_t> m_stacks;
+  std::atomic<size_t> m_remaining;
+  lock_t m_lock;
+  cond_t m_cond;
+  bool m_running;
+
+public:
+  explicit evt_graph(stack_allocator_t upstream = stack_allocator_t())
+      : m_nodes(), m_roots(),
+        m_stacks(std::make_shared<pool_t>(std::move(upstream))),
+        m_remaining(0), m_lock(), m_cond(), m_running(false) {}
+
+  virtual ~evt_graph() { ASSERT(!m_running); }
+
+  /// not copyable
+  evt_graph(evt_graph const &) = delete;
+
+  /// not assignable
+  evt_graph &operator=(evt_graph const &) = delete;
+
+  /**
+   * @brief declare a node, returning its id
+   *
+   * @param fn node function, called with the values of `deps`
+   * @param deps ids of earlier nodes. Since every dependency must already
+   *        have been declared, the graph cannot have cycles.
+   * @throws std::out_of_range for a dependency not yet declared
+   */
+  node_id add_node(func_t fn, std::vector<node_id> deps = {}) {
+    ASSERT(!m_running);
+    const node_id id = m_nodes.size();
+    for (node_id dd : deps) {
+      if (dd >= id) {
+        throw std::out_of_range("evt_graph: dependency on an undeclared node");
+      }
+    }
+    for (node_id dd : deps) {
+      m_nodes[dd]->dependents.push_back(id);
+    }
+    if (deps.empty()) {
+      m_roots.push_back(id);
+    }
+    m_nodes.emplace_back(
+        std::make_unique<node>(std::move(fn), std::move(deps)));
+    return id;
+  }
+
+  size_t size() const noexcept { return m_nodes.size(); }
+
+  /**
+   * @brief run every node in the graph
+   *
+   * The calling fiber will block until all nodes have completed. Values
+   * from any previous run will be discarded.
+   */
+  void run() {
+    ASSERT(!m_running);
+    if (m_nodes.empty()) {
+      return;
+    }
+    for (auto &nd : m_nodes) {
+      nd->value.reset();
+      nd->pending.store(nd->deps.size(), std::memory_order_relaxed);
+    }
+    m_remaining.store(m_nodes.size(), std::memory_order_release);
+    m_running = true;
+    for (node_id id : m_roots) {
+      launch(id);
+    }
+    std::unique_lock<lock_t> lck(m_lock);
+    while (m_running) {
+      m_cond.wait(lck);
+    }
+  }
+
+  /// the value of a node, after run()
+  T &value(node_id id) {
+    ASSERT(id < m_nodes.size() && m_nodes[id]->value.has_value());
+    return m_nodes[id]->value.value();
+  }
+
+  /// stacks for the graph's fibers
+  pool_t &stacks() noexcept { return *m_stacks; }
+
+protected:
+  void launch(node_id id) {
+    boost::fibers::fiber(std::allocator_arg, m_stacks->get_allocator(),
+                         [this, id]() { run_node(id); })
+        .detach();
+  }
+
+  void run_node(node_id id) {
+    while (true) {
+      node &nd = *m_nodes[id];
+      for (size_t ii = 0; ii < nd.deps.size(); ++ii) {
+        nd.inputs[ii] = &m_nodes[nd.deps[ii]]->value.value();
+      }
+      nd.value.emplace(nd.func(inputs_t(nd.inputs)));
+
+      // the first dependent made ready will be run within this fiber,
+      // with a new fiber for each other
+      bool have_next = false;
+      node_id next = 0;
+      for (node_id dd : nd.dependents) {
+        if (m_nodes[dd]->pending.fetch_sub(1, std::memory_order_acq_rel) ==
+            1) {
+          if (have_next) {
+            launch(dd);
+          } else {
+            next = dd;
+            have_next = true;
+          }
+        }
+      }
+      if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::unique_lock<lock_t> lck(m_lock);
+        m_running = false;
+        m_cond.notify_all();
+      }
+      if (!have_next) {
+        return;
+      }
+      id = next;
+    }
+  }
+};
+
+} // namespace evtlet
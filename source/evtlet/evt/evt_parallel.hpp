@@ -0,0 +1,154 @@
+/**
+ * @file evt_parallel.hpp
+ * @brief parallel_for and map_reduce, with recursive splitting onto
+ * evt_fiber tasks
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include <evtlet/evt/evt_fiber.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief shared parameters for the events of one map_reduce() call
+ *
+ * @tparam T value type for the reduction
+ * @tparam Map callable type, producing a `T` for each index
+ * @tparam Reduce callable type, combining two `T` values
+ */
+template <typename T, typename Map, typename Reduce> struct map_reduce_task {
+  const size_t grain;
+  const T init;
+  const Map &map;
+  const Reduce &reduce;
+};
+
+/**
+ * @brief event for map_reduce() over a half-open range of indices
+ *
+ * When the range is no larger than the grain size for the task, the range
+ * will be reduced sequentially within the event's fiber. Otherwise, the
+ * lower half of the range will be dispatched as a detached sub-event, while
+ * the upper half is reduced recursively within the current fiber. The
+ * sub-event may then be run by any idle worker, e.g under a work-stealing
+ * scheduler algorithm.
+ */
+template <typename T, typename Index, typename Map, typename Reduce>
+class map_reduce_evt : public evt_fiber<T> {
+public:
+  using task_t = map_reduce_task<T, Map, Reduce>;
+
+  static_assert(std::is_integral_v<Index>,
+                "map_reduce_evt requires an integral index type");
+
+private:
+  const task_t &m_task;
+  const Index m_first, m_last;
+
+public:
+  map_reduce_evt(const task_t &task, Index first, Index last)
+      : evt_fiber<T>(scheduling::SCHED_DEFER), m_task(task), m_first(first),
+        m_last(last) {}
+
+protected:
+  virtual T func() { return reduce_range(m_first, m_last); }
+
+  T reduce_range(Index first, Index last) {
+    const auto nn = static_cast<size_t>(last - first);
+    if (nn <= m_task.grain) {
+      T acc = m_task.init;
+      for (Index ii = first; ii != last; ++ii) {
+        acc = m_task.reduce(std::move(acc), m_task.map(ii));
+      }
+      return acc;
+    } else {
+      const auto mid = static_cast<Index>(first + static_cast<Index>(nn / 2));
+      map_reduce_evt lhs(m_task, first, mid);
+      lhs.dispatch_detached();
+      T rv = reduce_range(mid, last);
+      T &lv = lhs.get();
+      return m_task.reduce(std::move(lv), std::move(rv));
+    }
+  }
+};
+
+/**
+ * @brief reduce `map(ii)` for each index `ii` in `[first, last)`
+ *
+ * Work will be split onto `evt_fiber` events, down to at most `grain`
+ * indices per event. The calling fiber will block until all events have
+ * completed.
+ *
+ * `init` must be an identity value for `reduce`, as it will be used for
+ * each sequential reduction. `reduce` must be associative, though it need
+ * not be commutative: the order of values will be preserved.
+ *
+ * With a `worker_pool`, `map` and `reduce` may be called concurrently
+ * from different threads.
+ */
+template <typename T, typename Index, typename Map, typename Reduce>
+T map_reduce(Index first, Index last, size_t grain, T init, Map map,
+             Reduce reduce) {
+  if (!(first < last)) {
+    return init;
+  }
+  const map_reduce_task<T, Map, Reduce> task{grain ? grain : 1,
+                                             std::move(init), map, reduce};
+  map_reduce_evt<T, Index, Map, Reduce> root(task, first, last);
+  return std::move(root.get());
+}
+
+/// map_reduce() for each element of a random-access range
+template <std::ranges::random_access_range R, typename T, typename Map,
+          typename Reduce>
+  requires std::ranges::sized_range<R>
+T map_reduce(R &&range, size_t grain, T init, Map map, Reduce reduce) {
+  auto first = std::ranges::begin(range);
+  const auto nn = static_cast<size_t>(std::ranges::size(range));
+  return map_reduce(
+      static_cast<size_t>(0), nn, grain, std::move(init),
+      [&first, &map](size_t ii) {
+        return map(first[static_cast<std::iter_difference_t<decltype(first)>>(
+            ii)]);
+      },
+      std::move(reduce));
+}
+
+/**
+ * @brief call `func(ii)` for each index `ii` in `[first, last)`
+ *
+ * Work will be split onto events as with map_reduce()
+ */
+template <typename Index, typename Func>
+void parallel_for(Index first, Index last, size_t grain, Func func) {
+  static_cast<void>(map_reduce(
+      first, last, grain, static_cast<size_t>(0),
+      [&func](Index ii) {
+        func(ii);
+        return static_cast<size_t>(1);
+      },
+      [](size_t lv, size_t rv) { return lv + rv; }));
+}
+
+/// parallel_for() for each element of a random-access range
+template <std::ranges::random_access_range R, typename Func>
+  requires std::ranges::sized_range<R>
+void parallel_for(R &&range, size_t grain, Func func) {
+  auto first = std::ranges::begin(range);
+  const auto nn = static_cast<size_t>(std::ranges::size(range));
+  parallel_for(static_cast<size_t>(0), nn, grain, [&first, &func](size_t ii) {
+    func(first[static_cast<std::iter_difference_t<decltype(first)>>(ii)]);
+  });
+}
+
+} // namespace evtlet
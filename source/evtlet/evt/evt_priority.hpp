@@ -0,0 +1,430 @@
+/**
+ * @file evt_priority.hpp
+ * @brief priority scheduling and admission control for evt_fiber
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+// cf. boost libs/fiber/examples/priority.cpp
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/evt/evt_props.hpp>
+#include <evtlet/util/dbg.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief scheduler algorithm with one ready queue per evt_priority
+ *
+ * Ready fibers will be run in FIFO order within each priority level. A
+ * fiber at some priority level will be run only when no fiber is ready at
+ * any higher level.
+ *
+ * __Known Limitation:__ With strict priority, bulk work will be starved
+ * for as long as higher priority fibers are ready. Combined with
+ * `evt_admission`, the number of events at all priorities will be bounded.
+ */
+class priority_scheduler
+    : public boost::fibers::algo::algorithm_with_properties<evt_props> {
+public:
+  using ready_queue_t = boost::fibers::scheduler::ready_queue_type;
+
+private:
+  std::array<ready_queue_t, evt_priority_levels> m_queues;
+  std::mutex m_mtx;
+  std::condition_variable m_cnd;
+  bool m_flag;
+
+public:
+  priority_scheduler() : m_queues(), m_mtx(), m_cnd(), m_flag(false) {}
+
+  /// not copyable
+  priority_scheduler(priority_scheduler const &) = delete;
+
+  /// not assignable
+  priority_scheduler &operator=(priority_scheduler const &) = delete;
+
+  void awakened(boost::fibers::context *ctx, evt_props &props) noexcept {
+    const auto level = static_cast<size_t>(props.get_priority());
+    ASSERT(level < evt_priority_levels);
+    m_queues[level].push_back(*ctx);
+  }
+
+  boost::fibers::context *pick_next() noexcept {
+    for (size_t ii = evt_priority_levels; ii > 0; --ii) {
+      auto &queue = m_queues[ii - 1];
+      if (!queue.empty()) {
+        boost::fibers::context *ctx = &queue.front();
+        queue.pop_front();
+        return ctx;
+      }
+    }
+    return nullptr;
+  }
+
+  bool has_ready_fibers() const noexcept {
+    for (const auto &queue : m_queues) {
+      if (!queue.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void property_change(boost::fibers::context *ctx,
+                       evt_props &props) noexcept {
+    if (ctx->ready_is_linked()) {
+      // requeue a ready fiber at its new priority
+      ctx->ready_unlink();
+      awakened(ctx, props);
+    }
+  }
+
+  void suspend_until(
+      std::chrono::steady_clock::time_point const &abs_time) noexcept {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    if ((std::chrono::steady_clock::time_point::max)() == abs_time) {
+      m_cnd.wait(lck, [this]() { return m_flag; });
+    } else {
+      m_cnd.wait_until(lck, abs_time, [this]() { return m_flag; });
+    }
+    m_flag = false;
+  }
+
+  void notify() noexcept {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    m_flag = true;
+    lck.unlock();
+    m_cnd.notify_all();
+  }
+};
+
+/**
+ * @brief global limit for the number of events in flight
+ *
+ * Once the limit has been reached, a submitted event will be queued
+ * without launching a fiber. When an event in flight completes, the
+ * earliest queued event at the highest priority will be launched in its
+ * place.
+ *
+ * A queued event may be withdrawn with the ticket returned by `submit()`,
+ * e.g when the event is destroyed before it has been admitted.
+ *
+ * The admission gate may be shared across threads. It must outlive every
+ * event submitted to it.
+ */
+class evt_admission {
+public:
+  using launch_t = std::function<void()>;
+  using ticket_t = uint64_t;
+
+  /// ticket for an event launched directly from `submit()`
+  static constexpr ticket_t launched = 0;
+
+private:
+  struct entry {
+    ticket_t ticket;
+    launch_t launch;
+  };
+
+  // a thread lock, never held while launching a fiber
+  std::mutex m_lock;
+  const size_t m_limit;
+  size_t m_inflight;
+  ticket_t m_next_ticket;
+  std::array<std::deque<entry>, evt_priority_levels> m_queued;
+
+public:
+  explicit evt_admission(size_t limit)
+      : m_lock(), m_limit(limit ? limit : 1), m_inflight(0),
+        m_next_ticket(launched + 1), m_queued() {}
+
+  /// not copyable
+  evt_admission(evt_admission const &) = delete;
+
+  /// not assignable
+  evt_admission &operator=(evt_admission const &) = delete;
+
+  /**
+   * @brief launch the event now, if under the limit, else queue it
+   *
+   * @return a ticket for `withdraw()` if the event was queued, else
+   *         `launched`
+   */
+  ticket_t submit(evt_priority prio, launch_t &&launch) {
+    std::unique_lock<std::mutex> lck(m_lock);
+    if (m_inflight < m_limit) {
+      ++m_inflight;
+      lck.unlock();
+      launch();
+      return launched;
+    } else {
+      const ticket_t ticket = m_next_ticket++;
+      m_queued[static_cast<size_t>(prio)].push_back(
+          entry{ticket, std::move(launch)});
+      return ticket;
+    }
+  }
+
+  /**
+   * @brief remove a queued event, before it has been launched
+   *
+   * @return true if the event was removed, false if it has been launched
+   */
+  bool withdraw(evt_priority prio, ticket_t ticket) {
+    if (ticket == launched) {
+      return false;
+    }
+    std::unique_lock<std::mutex> lck(m_lock);
+    auto &queue = m_queued[static_cast<size_t>(prio)];
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+      if (it->ticket == ticket) {
+        queue.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// record the completion of an event in flight
+  void complete() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    for (size_t ii = evt_priority_levels; ii > 0; --ii) {
+      auto &queue = m_queued[ii - 1];
+      if (!queue.empty()) {
+        launch_t launch = std::move(queue.front().launch);
+        queue.pop_front();
+        lck.unlock();
+        // the completed event's slot passes to the queued event
+        launch();
+        return;
+      }
+    }
+    ASSERT(m_inflight > 0);
+    --m_inflight;
+  }
+
+  size_t limit() const noexcept { return m_limit; }
+
+  size_t inflight() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    return m_inflight;
+  }
+
+  size_t queued() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    size_t nn = 0;
+    for (const auto &queue : m_queued) {
+      nn += queue.size();
+    }
+    return nn;
+  }
+};
+
+/**
+ * @brief evt_fiber with a priority, optionally under admission control
+ *
+ * The event's fiber will be launched with the event's priority, for
+ * scheduling under `priority_scheduler`. With other scheduler algorithms,
+ * the priority will be used only for admission.
+ *
+ * With an `evt_admission` gate, the event's fiber will not be created
+ * until the event has been admitted. Until then, `dispatch()` and `get()`
+ * will wait for the event without launching it. An event destroyed while
+ * queued will be withdrawn from the gate. If the event has been admitted
+ * from the queue but its function has not started, the destructor will
+ * cancel the event, waiting for the launch and for the event's fiber to
+ * release the event. Otherwise, once admitted, the event must complete
+ * before it is destroyed, as for any `evt_fiber`.
+ *
+ * An admitted event holds its slot in the gate until it completes. A
+ * nested `get()` from within an admitted event, for another event under
+ * the same gate, will deadlock once every slot is held by such a waiter.
+ */
+template <typename T, typename condition_lock_t = boost::fibers::mutex,
+          typename condition_t = boost::fibers::condition_variable,
+          typename stack_allocator_t = boost::fibers::default_stack>
+class evt_prio
+    : public evt_fiber<T, condition_lock_t, condition_t, stack_allocator_t> {
+public:
+  using base_t =
+      evt_fiber<T, condition_lock_t, condition_t, stack_allocator_t>;
+  using fiber_t = typename base_t::fiber_t;
+
+private:
+  /// admission state for a queued event
+  enum class admit_state : size_t {
+    ADMIT_QUEUED = 0,
+    ADMIT_LAUNCHING = 1,
+    ADMIT_LAUNCHED = 2,
+    ADMIT_RUNNING = 3,
+    ADMIT_WITHDRAWN = 4,
+    ADMIT_CANCELLED = 5
+  };
+
+  /// admission state for a queued event, shared with the gate's launch
+  struct admit_t {
+    boost::fibers::mutex lock;
+    boost::fibers::condition_variable cond;
+    admit_state state = admit_state::ADMIT_QUEUED;
+
+    /// update the state if at `from`, waking any waiter
+    bool advance(admit_state from, admit_state to) {
+      std::unique_lock<boost::fibers::mutex> lck(lock);
+      if (state != from) {
+        return false;
+      }
+      state = to;
+      cond.notify_all();
+      return true;
+    }
+  };
+
+  const evt_priority m_priority;
+  evt_admission *const m_gate;
+  std::atomic<bool> m_submitted;
+  std::atomic<evt_admission::ticket_t> m_ticket;
+  std::shared_ptr<admit_t> m_admit;
+
+public:
+  explicit evt_prio(evt_priority prio = evt_priority::PRIO_NORMAL,
+                    evt_admission *gate = nullptr,
+                    scheduling sched = scheduling::SCHED_DEFER)
+      : base_t(scheduling::SCHED_DEFER), m_priority(prio), m_gate(gate),
+        m_submitted(false), m_ticket(evt_admission::launched),
+        m_admit(gate ? std::make_shared<admit_t>() : nullptr) {
+    // dispatched here rather than in the base constructor, such that the
+    // launch will be handled by this class
+    if (static_cast<size_t>(sched) &
+        static_cast<size_t>(scheduling::SCHED_IMMED)) {
+      dispatch_detached();
+    }
+  }
+
+  virtual ~evt_prio() {
+    const evt_admission::ticket_t ticket = m_ticket.load();
+    if (m_gate && ticket != evt_admission::launched &&
+        !m_gate->withdraw(m_priority, ticket)) {
+      _cancel_admitted();
+    }
+  }
+
+  evt_priority get_priority() const noexcept { return m_priority; }
+
+  virtual T &get() {
+    if (!this->done()) {
+      submit();
+      this->wait();
+    }
+    return base_t::get();
+  }
+
+  virtual void dispatch() {
+    submit();
+    this->wait();
+  }
+
+  virtual void dispatch_detached() { submit(); }
+
+  virtual fiber_t *ensure_fiber(bool detach = false) {
+    evt_launch_scope scope(m_priority);
+    return base_t::ensure_fiber(detach);
+  }
+
+protected:
+  /// submit the event for admission, at most once
+  virtual void submit() {
+    if (m_submitted.exchange(true)) {
+      return;
+    }
+    if (m_gate) {
+      m_ticket.store(m_gate->submit(
+          m_priority, [this, admit = m_admit, gate = m_gate]() {
+            if (!admit->advance(admit_state::ADMIT_QUEUED,
+                                admit_state::ADMIT_LAUNCHING)) {
+              // withdrawn by the destructor. The slot passes to the next
+              // queued event
+              gate->complete();
+              return;
+            }
+            base_t::dispatch_detached();
+            // the event's fiber may have started already
+            admit->advance(admit_state::ADMIT_LAUNCHING,
+                           admit_state::ADMIT_LAUNCHED);
+          }));
+    } else {
+      base_t::dispatch_detached();
+    }
+  }
+
+  virtual void dispatch_func() {
+    // the event may be destroyed by a waiter, once the value is published
+    evt_admission *gate = m_gate;
+    if (gate) {
+      const std::shared_ptr<admit_t> admit = m_admit;
+      std::unique_lock<boost::fibers::mutex> lck(admit->lock);
+      if (admit->state == admit_state::ADMIT_WITHDRAWN) {
+        // cancelled by the destructor, which waits for this update
+        admit->state = admit_state::ADMIT_CANCELLED;
+        admit->cond.notify_all();
+        lck.unlock();
+        gate->complete();
+        return;
+      }
+      admit->state = admit_state::ADMIT_RUNNING;
+    }
+    base_t::dispatch_func();
+    if (gate) {
+      gate->complete();
+    }
+  }
+
+private:
+  /// called from the destructor, for an event admitted from the queue
+  void _cancel_admitted() {
+    admit_t &admit = *m_admit;
+    std::unique_lock<boost::fibers::mutex> lck(admit.lock);
+    if (admit.state == admit_state::ADMIT_QUEUED) {
+      // the launch will not access the event
+      admit.state = admit_state::ADMIT_WITHDRAWN;
+      return;
+    }
+    // the launch may be in progress on some other thread
+    while (admit.state == admit_state::ADMIT_LAUNCHING) {
+      admit.cond.wait(lck);
+    }
+    if (admit.state == admit_state::ADMIT_LAUNCHED) {
+      // the event's fiber will not call func()
+      admit.state = admit_state::ADMIT_WITHDRAWN;
+      while (admit.state != admit_state::ADMIT_CANCELLED) {
+        admit.cond.wait(lck);
+      }
+    } else {
+      // func() has started
+      lck.unlock();
+      this->wait();
+    }
+  }
+};
+
+} // namespace evtlet
@@ -0,0 +1,131 @@
+/**
+ * @file evt_props.hpp
+ * @brief fiber properties for evtlet scheduler algorithms
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/properties.hpp>
+
+namespace evtlet {
+
+enum class evt_priority : size_t {
+  PRIO_BULK = 0,
+  PRIO_NORMAL = 1,
+  PRIO_HIGH = 2,
+  PRIO_CRITICAL = 3
+};
+
+/// number of evt_priority levels
+constexpr size_t evt_priority_levels = 4;
+
+/**
+ * @brief properties for each fiber under an evtlet scheduler algorithm
+ *
+ * The initial priority for a new fiber will be taken from the launch hint
+ * for the launching thread, if set with `evt_launch_scope`. Otherwise, the
+ * fiber will have the priority `PRIO_NORMAL`.
+ *
+ * Similarly, the tag for a new fiber will be taken from any `evt_tag_scope`
+ * on the launching thread. For the fiber of an `evt_fiber`, this will be
+ * the event's `evt_tag()`.
+ */
+class evt_props : public boost::fibers::fiber_properties {
+private:
+  evt_priority m_priority;
+  const char *m_tag;
+
+  static evt_priority &_launch_hint() noexcept {
+    static thread_local evt_priority hint = evt_priority::PRIO_NORMAL;
+    return hint;
+  }
+
+  static const char *&_tag_hint() noexcept {
+    static thread_local const char *hint = nullptr;
+    return hint;
+  }
+
+  friend class evt_launch_scope;
+  friend class evt_tag_scope;
+
+public:
+  explicit evt_props(boost::fibers::context *ctx)
+      : boost::fibers::fiber_properties(ctx), m_priority(_launch_hint()),
+        m_tag(_tag_hint()) {}
+
+  evt_priority get_priority() const noexcept { return m_priority; }
+
+  void set_priority(evt_priority prio) noexcept {
+    if (prio != m_priority) {
+      m_priority = prio;
+      // inform the algorithm, e.g for a fiber in a ready queue
+      notify();
+    }
+  }
+
+  /// identity for the fiber's event, or nullptr
+  const char *get_tag() const noexcept { return m_tag; }
+
+  /// set the tag, which must be a string with static storage duration
+  void set_tag(const char *tag) noexcept { m_tag = tag; }
+};
+
+/**
+ * @brief scoped launch hint, for fibers created on the current thread
+ *
+ * The fiber properties for a new fiber will be created when the fiber is
+ * first scheduled, i.e within the fiber's constructor. Setting the hint
+ * before launch ensures that the fiber will be queued at its own priority
+ * from the start.
+ */
+class evt_launch_scope {
+private:
+  const evt_priority m_prev;
+
+public:
+  explicit evt_launch_scope(evt_priority prio) noexcept
+      : m_prev(evt_props::_launch_hint()) {
+    evt_props::_launch_hint() = prio;
+  }
+
+  ~evt_launch_scope() { evt_props::_launch_hint() = m_prev; }
+
+  /// not copyable
+  evt_launch_scope(evt_launch_scope const &) = delete;
+
+  /// not assignable
+  evt_launch_scope &operator=(evt_launch_scope const &) = delete;
+};
+
+/**
+ * @brief scoped tag hint, for fibers created on the current thread
+ *
+ * The tag must be a string with static storage duration, e.g a string
+ * literal or the name from a `std::type_info`.
+ */
+class evt_tag_scope {
+private:
+  const char *const m_prev;
+
+public:
+  explicit evt_tag_scope(const char *tag) noexcept
+      : m_prev(evt_props::_tag_hint()) {
+    evt_props::_tag_hint() = tag;
+  }
+
+  ~evt_tag_scope() { evt_props::_tag_hint() = m_prev; }
+
+  /// not copyable
+  evt_tag_scope(evt_tag_scope const &) = delete;
+
+  /// not assignable
+  evt_tag_scope &operator=(evt_tag_scope const &) = delete;
+};
+
+} // namespace evtlet
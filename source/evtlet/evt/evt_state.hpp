@@ -1,8 +1,9 @@
-
 #pragma once
 
 #include <cstddef>
 
+#include <evtlet/util/mask.hpp>
+
 namespace evtlet {
 
 enum class evt_state : size_t {
@@ -15,3 +16,9 @@ enum class evt_state : size_t {
 };
 
 } // namespace evtlet
+
+// the enum_mask_t specialization must be declared in the global namespace,
+// such that DEFMASK_T cannot be used here
+template <> struct enum_mask_t<evtlet::evt_state> {
+  static constexpr bool enable = true;
+};
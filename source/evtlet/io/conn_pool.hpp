@@ -0,0 +1,293 @@
+/**
+ * @file conn_pool.hpp
+ * @brief client connection pool, with request pipelining and write batching
+ * for concurrent fibers
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/util/dbg.hpp>
+#include <evtlet/util/optional_source.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief pool of pipelined client connections, shared by many fibers
+ *
+ * Each call will be queued onto the least loaded connection in the pool.
+ * For each connection, a writer fiber will gather all requests queued by
+ * concurrent callers into a single `writev()`, while a reader fiber will
+ * match each response to the earliest request still in flight. The calling
+ * fiber will block until its response has been received.
+ *
+ * @tparam Conn connection type, providing fiber-blocking I/O, e.g using
+ *         `fd_stream`. The following members must be available:
+ *         - `writev(struct iovec *, int)` to write a complete batch of
+ *           requests, in order
+ *         - `read_response()` returning the next `Response` from the
+ *           connection
+ *
+ *         Errors should be reported as exceptions. Once an error has
+ *         occurred for a connection, every request queued or in flight for
+ *         that connection will fail with the same exception, and the
+ *         connection will not be used for later calls.
+ *
+ * @tparam Response response type for the connection
+ *
+ * The pool's fibers will be launched on the thread constructing the pool.
+ * The pool must not be destroyed while any call is pending.
+ */
+template <typename Conn, typename Response> class conn_pool {
+public:
+  using conn_t = Conn;
+  using response_t = Response;
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+  using fiber_t = boost::fibers::fiber;
+
+private:
+  /// a pending call, on the stack of the calling fiber
+  struct request {
+    const std::string_view payload;
+    OPTIONAL_T<response_t> value;
+    std::exception_ptr error;
+    bool done;
+    lock_t lock;
+    cond_t cond;
+
+    explicit request(std::string_view data)
+        : payload(data), value(NULLOPT), error(), done(false), lock(),
+          cond() {}
+
+    void complete(OPTIONAL_T<response_t> &&vv, std::exception_ptr ee) {
+      std::unique_lock<lock_t> lck(lock);
+      value = std::move(vv);
+      error = std::move(ee);
+      done = true;
+      cond.notify_all();
+    }
+  };
+
+  struct channel {
+    conn_t conn;
+    lock_t lock;
+    cond_t cond;
+    std::deque<request *> outq;
+    std::deque<request *> inflight;
+    std::vector<struct iovec> iov;
+    std::exception_ptr error;
+    bool stopped;
+    fiber_t writer;
+    fiber_t reader;
+
+    explicit channel(conn_t &&cc)
+        : conn(std::move(cc)), lock(), cond(), outq(), inflight(), iov(),
+          error(), stopped(false), writer(), reader() {}
+
+    size_t load() const noexcept { return outq.size() + inflight.size(); }
+  };
+
+  const size_t m_max_batch;
+  std::vector<std::unique_ptr<channel>> m_channels;
+
+public:
+  /**
+   * @param conns connections for the pool
+   * @param max_batch maximum number of requests per `writev()`
+   */
+  explicit conn_pool(std::vector<conn_t> &&conns, size_t max_batch = 64)
+      : m_max_batch(max_batch ? max_batch : 1), m_channels() {
+    if (conns.empty()) {
+      throw std::invalid_argument("conn_pool: no connections");
+    }
+    m_channels.reserve(conns.size());
+    for (auto &cc : conns) {
+      auto ch = std::make_unique<channel>(std::move(cc));
+      ch->iov.resize(m_max_batch);
+      channel *chp = ch.get();
+      ch->writer = fiber_t([this, chp]() { write_main(*chp); });
+      ch->reader = fiber_t([this, chp]() { read_main(*chp); });
+      m_channels.emplace_back(std::move(ch));
+    }
+  }
+
+  virtual ~conn_pool() {
+    for (auto &ch : m_channels) {
+      std::unique_lock<lock_t> lck(ch->lock);
+      ch->stopped = true;
+      lck.unlock();
+      ch->cond.notify_all();
+    }
+    for (auto &ch : m_channels) {
+      if (ch->writer.joinable()) {
+        ch->writer.join();
+      }
+      if (ch->reader.joinable()) {
+        ch->reader.join();
+      }
+    }
+  }
+
+  /// not copyable
+  conn_pool(conn_pool const &) = delete;
+
+  /// not assignable
+  conn_pool &operator=(conn_pool const &) = delete;
+
+  size_t size() const noexcept { return m_channels.size(); }
+
+  /**
+   * @brief send one encoded request and wait for its response
+   *
+   * The payload will not be copied. It must remain valid until the call
+   * has returned.
+   */
+  response_t call(std::string_view payload) {
+    request req(payload);
+    channel &ch = select_channel();
+    {
+      std::unique_lock<lock_t> lck(ch.lock);
+      if (ch.error) {
+        std::rethrow_exception(ch.error);
+      }
+      ch.outq.push_back(&req);
+    }
+    ch.cond.notify_all();
+
+    std::unique_lock<lock_t> lck(req.lock);
+    while (!req.done) {
+      req.cond.wait(lck);
+    }
+    if (req.error) {
+      std::rethrow_exception(req.error);
+    }
+    ASSERT(req.value.has_value());
+    return std::move(req.value.value());
+  }
+
+protected:
+  /// the connection with the fewest queued and in-flight requests
+  channel &select_channel() {
+    channel *best = nullptr;
+    size_t best_load = 0;
+    for (auto &ch : m_channels) {
+      std::unique_lock<lock_t> lck(ch->lock);
+      if (ch->error) {
+        continue;
+      }
+      const size_t load = ch->load();
+      if (!best || load < best_load) {
+        best = ch.get();
+        best_load = load;
+      }
+    }
+    if (!best) {
+      // every connection has failed
+      std::unique_lock<lock_t> lck(m_channels.front()->lock);
+      std::rethrow_exception(m_channels.front()->error);
+    }
+    return *best;
+  }
+
+  void write_main(channel &ch) {
+    std::unique_lock<lock_t> lck(ch.lock);
+    while (true) {
+      while (ch.outq.empty() && !ch.stopped) {
+        ch.cond.wait(lck);
+      }
+      if (ch.outq.empty() || ch.error) {
+        break;
+      }
+      // requests are moved to the in-flight queue before the write, such
+      // that each response can be matched in order by the reader
+      int nn = 0;
+      while (!ch.outq.empty() && static_cast<size_t>(nn) < m_max_batch) {
+        request *req = ch.outq.front();
+        ch.outq.pop_front();
+        ch.inflight.push_back(req);
+        ch.iov[static_cast<size_t>(nn)] = {
+            const_cast<char *>(req->payload.data()), req->payload.size()};
+        ++nn;
+      }
+      lck.unlock();
+      ch.cond.notify_all();
+      try {
+        ch.conn.writev(ch.iov.data(), nn);
+      } catch (...) {
+        fail_channel(ch, std::current_exception());
+      }
+      lck.lock();
+    }
+  }
+
+  void read_main(channel &ch) {
+    std::unique_lock<lock_t> lck(ch.lock);
+    while (true) {
+      while (ch.inflight.empty() && !ch.stopped && !ch.error) {
+        ch.cond.wait(lck);
+      }
+      if (ch.inflight.empty() || ch.error) {
+        break;
+      }
+      lck.unlock();
+      OPTIONAL_T<response_t> vv{NULLOPT};
+      try {
+        vv.emplace(ch.conn.read_response());
+      } catch (...) {
+        fail_channel(ch, std::current_exception());
+        lck.lock();
+        break;
+      }
+      lck.lock();
+      if (ch.error || ch.inflight.empty()) {
+        // the writer has failed every in-flight request, during the read
+        break;
+      }
+      request *req = ch.inflight.front();
+      ch.inflight.pop_front();
+      lck.unlock();
+      req->complete(std::move(vv), nullptr);
+      lck.lock();
+    }
+  }
+
+  /// fail every queued and in-flight request for the channel
+  void fail_channel(channel &ch, std::exception_ptr err) {
+    std::unique_lock<lock_t> lck(ch.lock);
+    if (!ch.error) {
+      ch.error = err;
+    }
+    std::deque<request *> failed;
+    failed.swap(ch.inflight);
+    for (auto *req : ch.outq) {
+      failed.push_back(req);
+    }
+    ch.outq.clear();
+    lck.unlock();
+    ch.cond.notify_all();
+    for (auto *req : failed) {
+      req->complete(NULLOPT, err);
+    }
+  }
+};
+
+} // namespace evtlet
@@ -0,0 +1,151 @@
+/**
+ * @file fd_stream.hpp
+ * @brief fiber-blocking I/O onto a non-blocking file descriptor
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <boost/fiber/operations.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief stream onto a file descriptor, blocking only the calling fiber
+ *
+ * The descriptor will be set to non-blocking mode. When a read or write
+ * would block, the calling fiber will wait within `wait_io()`, such that
+ * other fibers on the same thread may continue to run.
+ *
+ * The default `wait_io()` yields to other ready fibers, or polls the
+ * descriptor when no other fiber is ready. Subclasses may override
+ * `wait_io()` e.g to wait on an event loop watcher.
+ *
+ * The stream owns the descriptor and will close it on destruction.
+ *
+ * Errors are reported as `std::system_error`.
+ */
+class fd_stream {
+private:
+  int m_fd;
+
+public:
+  explicit fd_stream(int fd) : m_fd(fd) {
+    const int flags = ::fcntl(m_fd, F_GETFL);
+    if (flags < 0 || ::fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+      throw std::system_error(errno, std::generic_category(), "fcntl");
+    }
+  }
+
+  fd_stream(fd_stream &&other) noexcept : m_fd(std::exchange(other.m_fd, -1)) {}
+
+  fd_stream &operator=(fd_stream &&other) noexcept {
+    if (this != &other) {
+      close();
+      m_fd = std::exchange(other.m_fd, -1);
+    }
+    return *this;
+  }
+
+  /// not copyable
+  fd_stream(fd_stream const &) = delete;
+
+  /// not assignable
+  fd_stream &operator=(fd_stream const &) = delete;
+
+  virtual ~fd_stream() { close(); }
+
+  int fd() const noexcept { return m_fd; }
+
+  void close() noexcept {
+    if (m_fd >= 0) {
+      ::close(m_fd);
+      m_fd = -1;
+    }
+  }
+
+  /// read at most `len` bytes, returning zero at end of file
+  size_t read_some(void *buf, size_t len) {
+    while (true) {
+      const ssize_t nn = ::read(m_fd, buf, len);
+      if (nn >= 0) {
+        return static_cast<size_t>(nn);
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        wait_io(POLLIN);
+      } else if (errno != EINTR) {
+        throw std::system_error(errno, std::generic_category(), "read");
+      }
+    }
+  }
+
+  /**
+   * @brief write the complete buffer list, returning the number of bytes
+   * written
+   *
+   * The entries of `iov` will be advanced in place after any partial write
+   */
+  size_t writev(struct iovec *iov, int iovcnt) {
+    size_t total = 0;
+    for (int ii = 0; ii < iovcnt; ++ii) {
+      total += iov[ii].iov_len;
+    }
+    struct iovec *pos = iov;
+    int nleft = iovcnt;
+    while (nleft > 0) {
+      const ssize_t nn = ::writev(m_fd, pos, nleft);
+      if (nn >= 0) {
+        auto nw = static_cast<size_t>(nn);
+        while (nleft > 0 && nw >= pos->iov_len) {
+          nw -= pos->iov_len;
+          ++pos;
+          --nleft;
+        }
+        if (nleft > 0) {
+          pos->iov_base = static_cast<char *>(pos->iov_base) + nw;
+          pos->iov_len -= nw;
+        }
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        wait_io(POLLOUT);
+      } else if (errno != EINTR) {
+        throw std::system_error(errno, std::generic_category(), "writev");
+      }
+    }
+    return total;
+  }
+
+  size_t write(const void *buf, size_t len) {
+    struct iovec iov{const_cast<void *>(buf), len};
+    return writev(&iov, 1);
+  }
+
+protected:
+  /**
+   * @brief wait until the descriptor may be ready for `events`
+   *
+   * @param events `POLLIN` or `POLLOUT`
+   */
+  virtual void wait_io(short events) {
+    if (boost::fibers::has_ready_fibers()) {
+      boost::this_fiber::yield();
+    } else {
+      // no other fiber to run on this thread, block briefly in poll
+      struct pollfd pfd{m_fd, events, 0};
+      static_cast<void>(::poll(&pfd, 1, 1));
+    }
+  }
+};
+
+} // namespace evtlet
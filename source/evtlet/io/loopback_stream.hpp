@@ -0,0 +1,209 @@
+/**
+ * @file loopback_stream.hpp
+ * @brief in-memory connected streams, for simulation in virtual time
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <sys/uio.h>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/rt/virtual_time.hpp>
+#include <evtlet/util/clock.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief one end of an in-memory connection, created with `loopback_pair()`
+ *
+ * The stream provides `read_some()`, `writev()` and `write()` as for
+ * `fd_stream`, without a file descriptor. Data written to one end will be
+ * readable at the other end once the connection's latency has elapsed on
+ * `evtlet::clock`.
+ *
+ * A reader waiting for data will park on a fiber condition, and will
+ * sleep with `vsleep_until()` for data not yet delivered. Under a
+ * `virtual_scheduler`, a simulated service using these streams will then
+ * wait only in virtual time, and each delivery will be ordered with the
+ * scheduler's other timers. Without a `virtual_scheduler`, the latency
+ * will elapse in real time.
+ *
+ * Writes are buffered without a limit and will not block. After `close()`
+ * on one end, reads at the other end will return zero once all delivered
+ * data has been read, and writes at the other end will fail with `EPIPE`.
+ *
+ * Errors are reported as `std::system_error`.
+ */
+class loopback_stream {
+public:
+  using time_point = clock::time_point;
+  using duration = clock::duration;
+
+private:
+  /// data in one direction, shared by the two ends
+  struct channel {
+    struct segment {
+      time_point due;
+      std::string data;
+    };
+
+    boost::fibers::mutex lock;
+    boost::fibers::condition_variable cond;
+    std::deque<segment> segments;
+    size_t offset = 0;
+    bool closed = false;
+  };
+
+  std::shared_ptr<channel> m_in;
+  std::shared_ptr<channel> m_out;
+  duration m_latency;
+
+  loopback_stream(std::shared_ptr<channel> in, std::shared_ptr<channel> out,
+                  duration latency)
+      : m_in(std::move(in)), m_out(std::move(out)), m_latency(latency) {}
+
+  friend std::pair<loopback_stream, loopback_stream>
+  loopback_pair(clock::duration latency);
+
+  static void _close(channel &ch) {
+    std::unique_lock<boost::fibers::mutex> lck(ch.lock);
+    ch.closed = true;
+    ch.cond.notify_all();
+  }
+
+public:
+  loopback_stream(loopback_stream &&other) noexcept = default;
+
+  loopback_stream &operator=(loopback_stream &&other) noexcept {
+    if (this != &other) {
+      close();
+      m_in = std::move(other.m_in);
+      m_out = std::move(other.m_out);
+      m_latency = other.m_latency;
+    }
+    return *this;
+  }
+
+  /// not copyable
+  loopback_stream(loopback_stream const &) = delete;
+
+  /// not assignable
+  loopback_stream &operator=(loopback_stream const &) = delete;
+
+  virtual ~loopback_stream() { close(); }
+
+  /// one-way latency for data written to this end
+  duration latency() const noexcept { return m_latency; }
+
+  void close() {
+    if (m_out) {
+      _close(*m_out);
+      m_out.reset();
+    }
+    if (m_in) {
+      _close(*m_in);
+      m_in.reset();
+    }
+  }
+
+  /// read at most `len` bytes, returning zero at end of stream
+  size_t read_some(void *buf, size_t len) {
+    if (!m_in) {
+      throw std::system_error(EBADF, std::generic_category(), "read");
+    }
+    channel &ch = *m_in;
+    std::unique_lock<boost::fibers::mutex> lck(ch.lock);
+    while (true) {
+      if (!ch.segments.empty()) {
+        const time_point due = ch.segments.front().due;
+        if (clock::now() < due) {
+          // in flight. Under a virtual_scheduler, this will advance the
+          // virtual time
+          lck.unlock();
+          vsleep_until(due);
+          lck.lock();
+          continue;
+        }
+        char *pos = static_cast<char *>(buf);
+        size_t nread = 0;
+        const time_point now = clock::now();
+        while (nread < len && !ch.segments.empty() &&
+               !(now < ch.segments.front().due)) {
+          const std::string &data = ch.segments.front().data;
+          const size_t nn = std::min(len - nread, data.size() - ch.offset);
+          std::memcpy(pos + nread, data.data() + ch.offset, nn);
+          nread += nn;
+          ch.offset += nn;
+          if (ch.offset == data.size()) {
+            ch.segments.pop_front();
+            ch.offset = 0;
+          }
+        }
+        return nread;
+      } else if (ch.closed) {
+        return 0;
+      }
+      ch.cond.wait(lck);
+    }
+  }
+
+  /// write the complete buffer list, returning the number of bytes written
+  size_t writev(struct iovec *iov, int iovcnt) {
+    if (!m_out) {
+      throw std::system_error(EBADF, std::generic_category(), "writev");
+    }
+    std::string data;
+    for (int ii = 0; ii < iovcnt; ++ii) {
+      data.append(static_cast<const char *>(iov[ii].iov_base),
+                  iov[ii].iov_len);
+    }
+    const size_t total = data.size();
+    channel &ch = *m_out;
+    std::unique_lock<boost::fibers::mutex> lck(ch.lock);
+    if (ch.closed) {
+      throw std::system_error(EPIPE, std::generic_category(), "writev");
+    }
+    if (total) {
+      ch.segments.push_back(
+          channel::segment{clock::now() + m_latency, std::move(data)});
+      ch.cond.notify_all();
+    }
+    return total;
+  }
+
+  size_t write(const void *buf, size_t len) {
+    struct iovec iov{const_cast<void *>(buf), len};
+    return writev(&iov, 1);
+  }
+};
+
+/**
+ * @brief create two connected `loopback_stream` ends
+ *
+ * @param latency one-way delivery time, in each direction
+ */
+inline std::pair<loopback_stream, loopback_stream>
+loopback_pair(clock::duration latency = clock::duration::zero()) {
+  auto aa = std::make_shared<loopback_stream::channel>();
+  auto bb = std::make_shared<loopback_stream::channel>();
+  return std::pair<loopback_stream, loopback_stream>(
+      loopback_stream(aa, bb, latency), loopback_stream(bb, aa, latency));
+}
+
+} // namespace evtlet
@@ -0,0 +1,205 @@
+/**
+ * @file evt_work_stealing.hpp
+ * @brief work-stealing scheduler algorithm, preferring victims on the same
+ * NUMA node
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+// cf. boost libs/fiber/src/algo/work_stealing.cpp
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/context_spinlock_queue.hpp>
+#include <boost/fiber/type.hpp>
+#include <boost/intrusive_ptr.hpp>
+
+#include <evtlet/util/dbg.hpp>
+
+namespace evtlet {
+
+class evt_work_stealing;
+
+/**
+ * @brief schedulers sharing work within one worker pool
+ *
+ * Unlike the static registry for `boost::fibers::algo::work_stealing`,
+ * each registry is local to one pool of threads.
+ */
+class steal_registry {
+private:
+  std::vector<boost::intrusive_ptr<evt_work_stealing>> m_schedulers;
+  std::vector<int> m_nodes;
+  std::atomic<bool> m_closed;
+
+  friend class evt_work_stealing;
+
+public:
+  explicit steal_registry(size_t nthreads)
+      : m_schedulers(nthreads), m_nodes(nthreads, 0), m_closed(false) {}
+
+  size_t size() const noexcept { return m_schedulers.size(); }
+
+  int node_of(size_t id) const noexcept { return m_nodes[id]; }
+
+  /**
+   * @brief stop all stealing, releasing each registered scheduler
+   *
+   * This must be called only once every other thread in the pool has
+   * exited.
+   */
+  void close() noexcept {
+    m_closed.store(true);
+    m_schedulers.clear();
+  }
+};
+
+/**
+ * @brief work-stealing algorithm for a `steal_registry`
+ *
+ * When the local ready queue is empty, a thread will try to steal a fiber
+ * from each other thread in the registry on the same NUMA node, then from
+ * threads on other nodes, starting at a random victim within each group.
+ * With `prefer_local` false, all other threads are tried in one group.
+ *
+ * Every thread in the registry must have installed its algorithm before
+ * any of the threads schedules a fiber.
+ */
+class evt_work_stealing : public boost::fibers::algo::algorithm {
+public:
+  using context_t = boost::fibers::context;
+  using registry_t = steal_registry;
+
+private:
+  const std::shared_ptr<registry_t> m_registry;
+  const size_t m_id;
+  const bool m_suspend;
+  const bool m_prefer_local;
+  boost::fibers::detail::context_spinlock_queue m_rqueue;
+  std::mutex m_mtx;
+  std::condition_variable m_cnd;
+  bool m_flag;
+  // victims in order of preference, initialized at the first steal
+  std::vector<size_t> m_local;
+  std::vector<size_t> m_remote;
+  bool m_victims_init;
+  std::minstd_rand m_rng;
+
+public:
+  evt_work_stealing(std::shared_ptr<registry_t> registry, size_t id,
+                    int node, bool suspend = false, bool prefer_local = true)
+      : m_registry(std::move(registry)), m_id(id), m_suspend(suspend),
+        m_prefer_local(prefer_local), m_rqueue(), m_mtx(), m_cnd(),
+        m_flag(false), m_local(), m_remote(), m_victims_init(false),
+        m_rng(static_cast<std::minstd_rand::result_type>(id + 1)) {
+    ASSERT(m_id < m_registry->size());
+    m_registry->m_schedulers[m_id] = this;
+    m_registry->m_nodes[m_id] = node;
+  }
+
+  /// not copyable
+  evt_work_stealing(evt_work_stealing const &) = delete;
+
+  /// not assignable
+  evt_work_stealing &operator=(evt_work_stealing const &) = delete;
+
+  void awakened(context_t *ctx) noexcept override {
+    if (!ctx->is_context(boost::fibers::type::pinned_context)) {
+      ctx->detach();
+    }
+    m_rqueue.push(ctx);
+  }
+
+  context_t *pick_next() noexcept override {
+    context_t *victim = m_rqueue.pop();
+    if (victim) {
+      if (!victim->is_context(boost::fibers::type::pinned_context)) {
+        context_t::active()->attach(victim);
+      }
+    } else if (!m_registry->m_closed.load(std::memory_order_relaxed)) {
+      if (!m_victims_init) {
+        init_victims();
+      }
+      victim = steal_from(m_local);
+      if (!victim) {
+        victim = steal_from(m_remote);
+      }
+      if (victim) {
+        ASSERT(!victim->is_context(boost::fibers::type::pinned_context));
+        context_t::active()->attach(victim);
+      }
+    }
+    return victim;
+  }
+
+  /// take a fiber from this thread's ready queue, for another thread
+  virtual context_t *steal() noexcept { return m_rqueue.steal(); }
+
+  bool has_ready_fibers() const noexcept override { return !m_rqueue.empty(); }
+
+  void suspend_until(
+      std::chrono::steady_clock::time_point const &abs_time) noexcept override {
+    if (m_suspend) {
+      std::unique_lock<std::mutex> lck(m_mtx);
+      if ((std::chrono::steady_clock::time_point::max)() == abs_time) {
+        m_cnd.wait(lck, [this]() { return m_flag; });
+      } else {
+        m_cnd.wait_until(lck, abs_time, [this]() { return m_flag; });
+      }
+      m_flag = false;
+    }
+  }
+
+  void notify() noexcept override {
+    if (m_suspend) {
+      std::unique_lock<std::mutex> lck(m_mtx);
+      m_flag = true;
+      lck.unlock();
+      m_cnd.notify_all();
+    }
+  }
+
+protected:
+  void init_victims() {
+    const int node = m_registry->m_nodes[m_id];
+    for (size_t ii = 0; ii < m_registry->size(); ++ii) {
+      if (ii == m_id) {
+        continue;
+      } else if (!m_prefer_local || m_registry->m_nodes[ii] == node) {
+        m_local.push_back(ii);
+      } else {
+        m_remote.push_back(ii);
+      }
+    }
+    m_victims_init = true;
+  }
+
+  context_t *steal_from(const std::vector<size_t> &victims) noexcept {
+    const size_t nn = victims.size();
+    if (!nn) {
+      return nullptr;
+    }
+    const size_t start = static_cast<size_t>(m_rng()) % nn;
+    for (size_t ii = 0; ii < nn; ++ii) {
+      auto &sched = m_registry->m_schedulers[victims[(start + ii) % nn]];
+      if (context_t *victim = sched->steal()) {
+        return victim;
+      }
+    }
+    return nullptr;
+  }
+};
+
+} // namespace evtlet
@@ -0,0 +1,121 @@
+/**
+ * @file numa_alloc.hpp
+ * @brief node-local fiber stacks and memory resources
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <boost/context/stack_context.hpp>
+#include <boost/context/stack_traits.hpp>
+
+#include <evtlet/util/dbg.hpp>
+#include <evtlet/util/numa.hpp>
+
+namespace evtlet {
+
+/// round `len` up to a whole number of pages
+inline size_t numa_page_round(size_t len) noexcept {
+  const auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return (len + page - 1) / page * page;
+}
+
+/**
+ * @brief fiber stack allocator, placing each stack on a NUMA node
+ *
+ * By default, the node will be the `numa_thread_node()` hint for the
+ * thread allocating the stack, i.e the thread launching the fiber. Without
+ * a node hint, stacks will be allocated as for an ordinary mmap.
+ *
+ * This satisfies the boost.context _StackAllocator_ concept, e.g for use
+ * as the `stack_allocator_t` for `evt_fiber`.
+ */
+class numa_stack {
+public:
+  using traits_type = boost::context::stack_traits;
+
+private:
+  size_t m_size;
+  int m_node;
+
+public:
+  explicit numa_stack(size_t size = traits_type::default_size(),
+                      int node = -1) noexcept
+      : m_size(numa_page_round(size)), m_node(node) {}
+
+  int node() const noexcept { return m_node < 0 ? numa_thread_node() : m_node; }
+
+  boost::context::stack_context allocate() {
+    void *vp = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (vp == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    const int nn = node();
+    if (nn >= 0) {
+      static_cast<void>(numa_bind(vp, m_size, nn));
+    }
+    boost::context::stack_context sctx;
+    sctx.size = m_size;
+    sctx.sp = static_cast<char *>(vp) + sctx.size;
+    return sctx;
+  }
+
+  void deallocate(boost::context::stack_context &sctx) noexcept {
+    ASSERT(sctx.sp);
+    void *vp = static_cast<char *>(sctx.sp) - sctx.size;
+    ::munmap(vp, sctx.size);
+  }
+};
+
+/**
+ * @brief memory resource with pages placed on a NUMA node
+ *
+ * Each allocation will be mapped separately, such that this may be best
+ * used as the upstream resource for a `std::pmr::monotonic_buffer_resource`
+ * or `std::pmr::unsynchronized_pool_resource`, e.g for a node-local event
+ * arena.
+ */
+class numa_resource : public std::pmr::memory_resource {
+private:
+  const int m_node;
+
+public:
+  explicit numa_resource(int node) noexcept : m_node(node) {}
+
+  int node() const noexcept { return m_node; }
+
+protected:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    ASSERT(alignment <= static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+    static_cast<void>(alignment);
+    const size_t len = numa_page_round(bytes ? bytes : 1);
+    void *vp = ::mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (vp == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    static_cast<void>(numa_bind(vp, len, m_node));
+    return vp;
+  }
+
+  void do_deallocate(void *ptr, size_t bytes, size_t) override {
+    ::munmap(ptr, numa_page_round(bytes ? bytes : 1));
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource &other)
+      const noexcept override {
+    return this == &other;
+  }
+};
+
+} // namespace evtlet
@@ -0,0 +1,123 @@
+/**
+ * @file stack_pool.hpp
+ * @brief reusable fiber stacks, shared across threads
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <boost/context/stack_context.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief free list of fiber stacks, for reuse across fibers
+ *
+ * Stacks will be allocated with the upstream allocator only when the free
+ * list is empty, and will be returned to the free list when each fiber
+ * terminates. Unlike `boost::fibers::pooled_fixedsize_stack`, a pool may be
+ * shared by fibers running on any thread, e.g under a `worker_pool`.
+ *
+ * A pool must be held by a `std::shared_ptr`. Each allocator for the pool
+ * holds a reference to it, such that the pool will remain available until
+ * every fiber using it has been destroyed.
+ *
+ * @tparam stack_allocator_t upstream stack allocator
+ */
+template <typename stack_allocator_t = boost::fibers::fixedsize_stack>
+class stack_pool
+    : public std::enable_shared_from_this<stack_pool<stack_allocator_t>> {
+public:
+  /// stack allocator for fibers, returning each stack to the pool
+  class allocator {
+  private:
+    std::shared_ptr<stack_pool> m_pool;
+
+  public:
+    explicit allocator(std::shared_ptr<stack_pool> pool)
+        : m_pool(std::move(pool)) {}
+
+    boost::context::stack_context allocate() { return m_pool->acquire(); }
+
+    void deallocate(boost::context::stack_context &sctx) noexcept {
+      m_pool->release(sctx);
+    }
+  };
+
+private:
+  std::mutex m_lock;
+  std::vector<boost::context::stack_context> m_free;
+  stack_allocator_t m_upstream;
+  size_t m_allocated;
+
+public:
+  explicit stack_pool(stack_allocator_t upstream = stack_allocator_t())
+      : m_lock(), m_free(), m_upstream(std::move(upstream)), m_allocated(0) {}
+
+  virtual ~stack_pool() {
+    for (auto &sctx : m_free) {
+      m_upstream.deallocate(sctx);
+    }
+  }
+
+  /// not copyable
+  stack_pool(stack_pool const &) = delete;
+
+  /// not assignable
+  stack_pool &operator=(stack_pool const &) = delete;
+
+  allocator get_allocator() { return allocator(this->shared_from_this()); }
+
+  /// allocate stacks until at least `count` are free
+  void reserve(size_t count) {
+    std::unique_lock<std::mutex> lck(m_lock);
+    while (m_free.size() < count) {
+      m_free.reserve(m_allocated + 1);
+      m_free.push_back(m_upstream.allocate());
+      ++m_allocated;
+    }
+  }
+
+  /// number of stacks allocated from upstream, whether free or in use
+  size_t allocated() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    return m_allocated;
+  }
+
+  /// number of free stacks
+  size_t idle() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    return m_free.size();
+  }
+
+protected:
+  boost::context::stack_context acquire() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    if (m_free.empty()) {
+      boost::context::stack_context sctx = m_upstream.allocate();
+      ++m_allocated;
+      // such that release() will not allocate
+      m_free.reserve(m_allocated);
+      return sctx;
+    }
+    boost::context::stack_context sctx = m_free.back();
+    m_free.pop_back();
+    return sctx;
+  }
+
+  void release(boost::context::stack_context &sctx) noexcept {
+    std::unique_lock<std::mutex> lck(m_lock);
+    m_free.push_back(sctx);
+  }
+};
+
+} // namespace evtlet
@@ -0,0 +1,206 @@
+/**
+ * @file stack_profile.hpp
+ * @brief high-water marks for fiber and continuation stacks
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/context/fixedsize_stack.hpp>
+#include <boost/context/stack_context.hpp>
+#include <boost/core/demangle.hpp>
+
+namespace evtlet {
+
+/// number of histogram buckets for stack usage
+constexpr size_t stack_usage_buckets = 16;
+
+/**
+ * @brief stack usage for one event type
+ *
+ * Bucket `ii` counts the stacks with a high-water mark of at most
+ * `1KiB << ii`, and more than half of that. The last bucket counts every
+ * larger stack.
+ */
+struct stack_usage {
+  std::string tag;
+  size_t count;
+  size_t max_used;
+  size_t total_used;
+  size_t stack_size;
+  std::array<size_t, stack_usage_buckets> buckets;
+
+  static size_t bucket_of(size_t used) noexcept {
+    size_t ii = 0;
+    for (size_t limit = 1024; ii + 1 < stack_usage_buckets && used > limit;
+         limit <<= 1) {
+      ++ii;
+    }
+    return ii;
+  }
+
+  static size_t bucket_limit(size_t ii) noexcept { return size_t(1024) << ii; }
+};
+
+/**
+ * @brief process-wide registry of stack usage by tag
+ *
+ * Usage may be recorded from any thread.
+ */
+class stack_profile {
+private:
+  std::mutex m_lock;
+  std::map<const char *, stack_usage> m_usage;
+
+public:
+  /// the registry for the process, never destroyed
+  static stack_profile &instance() {
+    // not destroyed at exit, such that stacks may be released later
+    static stack_profile *profile = new stack_profile();
+    return *profile;
+  }
+
+  /**
+   * @brief record the high-water mark for a stack
+   *
+   * @param tag string with static storage duration, e.g from `evt_tag()`
+   */
+  void record(const char *tag, size_t used, size_t stack_size) {
+    std::unique_lock<std::mutex> lck(m_lock);
+    auto it = m_usage.find(tag);
+    if (it == m_usage.end()) {
+      it = m_usage
+               .emplace(tag, stack_usage{tag ? tag : "", 0, 0, 0, 0, {}})
+               .first;
+    }
+    stack_usage &usage = it->second;
+    ++usage.count;
+    usage.max_used = std::max(usage.max_used, used);
+    usage.total_used += used;
+    usage.stack_size = std::max(usage.stack_size, stack_size);
+    ++usage.buckets[stack_usage::bucket_of(used)];
+  }
+
+  std::vector<stack_usage> snapshot() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    std::vector<stack_usage> rslt;
+    rslt.reserve(m_usage.size());
+    for (const auto &entry : m_usage) {
+      rslt.push_back(entry.second);
+    }
+    return rslt;
+  }
+
+  /// usage for one tag, with a count of zero if not recorded
+  stack_usage usage_of(const char *tag) {
+    std::unique_lock<std::mutex> lck(m_lock);
+    auto it = m_usage.find(tag);
+    return it == m_usage.end() ? stack_usage{tag ? tag : "", 0, 0, 0, 0, {}}
+                               : it->second;
+  }
+
+  void reset() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    m_usage.clear();
+  }
+
+  /// write a histogram for each tag, one line per bucket in use
+  void write(std::ostream &out) {
+    for (const auto &usage : snapshot()) {
+      out << boost::core::demangle(usage.tag.c_str()) << ": " << usage.count
+          << " stacks of " << usage.stack_size << " bytes, max "
+          << usage.max_used << ", mean "
+          << (usage.count ? usage.total_used / usage.count : 0) << "\n";
+      for (size_t ii = 0; ii < stack_usage_buckets; ++ii) {
+        if (usage.buckets[ii]) {
+          out << "  <= " << stack_usage::bucket_limit(ii)
+              << (ii + 1 < stack_usage_buckets ? "" : "+") << ": "
+              << usage.buckets[ii] << "\n";
+        }
+      }
+    }
+  }
+};
+
+/**
+ * @brief stack allocator recording the high-water mark for each stack
+ *
+ * Each stack will be filled with a canary pattern when allocated. When the
+ * stack is released, the number of bytes overwritten will be recorded in
+ * `stack_profile::instance()` under the allocator's tag.
+ *
+ * This is intended for profiling. Filling and scanning each stack adds
+ * cost in proportion to the stack size.
+ *
+ * The upstream allocator must not place a guard page within the stack's
+ * `stack_context`, e.g `boost::context::protected_fixedsize_stack` is not
+ * supported.
+ *
+ * @tparam Upstream stack allocator for each stack
+ */
+template <typename Upstream = boost::context::fixedsize_stack>
+class profiled_stack {
+public:
+  using upstream_t = Upstream;
+
+  static constexpr uintptr_t canary =
+      static_cast<uintptr_t>(0xa5a5a5a5a5a5a5a5ULL);
+
+private:
+  const char *m_tag;
+  upstream_t m_upstream;
+
+public:
+  explicit profiled_stack(const char *tag, upstream_t upstream = upstream_t())
+      : m_tag(tag), m_upstream(std::move(upstream)) {}
+
+  boost::context::stack_context allocate() {
+    boost::context::stack_context sctx = m_upstream.allocate();
+    uintptr_t *first = lowest(sctx);
+    uintptr_t *last = static_cast<uintptr_t *>(sctx.sp);
+    for (uintptr_t *pp = first; pp < last; ++pp) {
+      *pp = canary;
+    }
+    return sctx;
+  }
+
+  void deallocate(boost::context::stack_context &sctx) noexcept {
+    stack_profile::instance().record(m_tag, high_water(sctx), sctx.size);
+    m_upstream.deallocate(sctx);
+  }
+
+  /// bytes of the stack overwritten since allocate()
+  static size_t high_water(const boost::context::stack_context &sctx) noexcept {
+    const uintptr_t *pp = lowest(sctx);
+    const uintptr_t *last = static_cast<const uintptr_t *>(sctx.sp);
+    // the stack grows down, from sp
+    while (pp < last && *pp == canary) {
+      ++pp;
+    }
+    return static_cast<size_t>(reinterpret_cast<const char *>(last) -
+                               reinterpret_cast<const char *>(pp));
+  }
+
+private:
+  static uintptr_t *lowest(const boost::context::stack_context &sctx) noexcept {
+    auto addr = reinterpret_cast<uintptr_t>(sctx.sp) - sctx.size;
+    // round up to the first aligned word
+    addr = (addr + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+    return reinterpret_cast<uintptr_t *>(addr);
+  }
+};
+
+} // namespace evtlet
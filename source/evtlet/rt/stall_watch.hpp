@@ -0,0 +1,282 @@
+/**
+ * @file stall_watch.hpp
+ * @brief stall detection for fibers running past a time budget, with
+ * cooperative preemption points
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/core/demangle.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_props.hpp>
+#include <evtlet/util/clock.hpp>
+
+namespace evtlet {
+
+/// a fiber found running past the budget for a `stall_watchdog`
+struct stall_report {
+  /// thread running the fiber
+  std::thread::id thread;
+  /// the fiber's context, for identity only
+  const void *fiber;
+  /// tag from the fiber's `evt_props`, or nullptr
+  const char *tag;
+  /// time since the fiber was resumed
+  std::chrono::nanoseconds elapsed;
+};
+
+/**
+ * @brief run state for one thread, as stamped at each context switch
+ */
+class stall_slot {
+private:
+  const std::thread::id m_thread;
+  // start time in nanoseconds for the running fiber, or zero when idle
+  std::atomic<int64_t> m_started;
+  std::atomic<const void *> m_fiber;
+  std::atomic<const char *> m_tag;
+  // incremented at each switch, such that each stall is reported once
+  std::atomic<uint64_t> m_seq;
+  uint64_t m_reported_seq;
+  std::atomic<bool> m_yield;
+
+  friend class stall_watchdog;
+
+public:
+  stall_slot()
+      : m_thread(std::this_thread::get_id()), m_started(0), m_fiber(nullptr),
+        m_tag(nullptr), m_seq(0), m_reported_seq(0), m_yield(false) {}
+
+  /// not copyable
+  stall_slot(stall_slot const &) = delete;
+
+  /// not assignable
+  stall_slot &operator=(stall_slot const &) = delete;
+
+  /// timestamp for a switch, comparable across threads
+  static int64_t now_ns() noexcept {
+    // the coarse clock is used rather than the loop-cached time, which
+    // would be shared by every fiber resumed within one loop iteration
+    return clock::coarse_now().time_since_epoch().count();
+  }
+
+  /// slot for the calling thread, or nullptr if the thread is not watched
+  static stall_slot *&current() noexcept {
+    static thread_local stall_slot *slot = nullptr;
+    return slot;
+  }
+
+  /// record a switch to `ctx`, or to the idle dispatcher if nullptr
+  void stamp(boost::fibers::context *ctx) noexcept {
+    const char *tag = nullptr;
+    if (ctx) {
+      if (auto *props = dynamic_cast<evt_props *>(ctx->get_properties())) {
+        tag = props->get_tag();
+      }
+    }
+    m_fiber.store(ctx, std::memory_order_relaxed);
+    m_tag.store(tag, std::memory_order_relaxed);
+    m_yield.store(false, std::memory_order_relaxed);
+    m_seq.fetch_add(1, std::memory_order_relaxed);
+    m_started.store(ctx ? std::max<int64_t>(now_ns(), 1) : 0,
+                    std::memory_order_release);
+  }
+
+  /// true once, after the running fiber has exceeded the budget
+  bool take_yield() noexcept {
+    return m_yield.load(std::memory_order_relaxed) &&
+           m_yield.exchange(false, std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief watchdog thread, reporting fibers running past a time budget
+ *
+ * Each watched thread should install a `stall_watched` scheduler
+ * algorithm for the watchdog. The watchdog thread will test each watched
+ * thread once per period. When a fiber has run for longer than the budget
+ * since it was last resumed, the watchdog will report the fiber once, and
+ * will request a yield at the fiber's next `maybe_yield()`.
+ *
+ * Reports will be delivered on the watchdog thread. By default, each
+ * report will be written to `std::cerr`.
+ */
+class stall_watchdog {
+public:
+  using duration_t = std::chrono::nanoseconds;
+  using report_t = std::function<void(const stall_report &)>;
+
+private:
+  const duration_t m_budget;
+  const duration_t m_period;
+  const report_t m_report;
+  std::mutex m_lock;
+  std::condition_variable m_cond;
+  std::vector<std::shared_ptr<stall_slot>> m_slots;
+  std::atomic<size_t> m_nreported;
+  bool m_stopped;
+  std::thread m_thread;
+
+public:
+  explicit stall_watchdog(duration_t budget, duration_t period = duration_t(0),
+                          report_t report = nullptr)
+      : m_budget(budget),
+        m_period(period.count() ? period
+                                : std::max(budget / 4, duration_t(1))),
+        m_report(report ? std::move(report) : report_t(print_report)),
+        m_lock(), m_cond(), m_slots(), m_nreported(0), m_stopped(false),
+        m_thread([this]() { watch(); }) {}
+
+  virtual ~stall_watchdog() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    m_stopped = true;
+    lck.unlock();
+    m_cond.notify_all();
+    m_thread.join();
+  }
+
+  /// not copyable
+  stall_watchdog(stall_watchdog const &) = delete;
+
+  /// not assignable
+  stall_watchdog &operator=(stall_watchdog const &) = delete;
+
+  duration_t budget() const noexcept { return m_budget; }
+
+  /// number of stalls reported
+  size_t reported() const noexcept { return m_nreported.load(); }
+
+  /// watch the calling thread, until the slot is detached
+  std::shared_ptr<stall_slot> attach() {
+    auto slot = std::make_shared<stall_slot>();
+    std::unique_lock<std::mutex> lck(m_lock);
+    m_slots.push_back(slot);
+    return slot;
+  }
+
+  void detach(const std::shared_ptr<stall_slot> &slot) {
+    std::unique_lock<std::mutex> lck(m_lock);
+    m_slots.erase(std::remove(m_slots.begin(), m_slots.end(), slot),
+                  m_slots.end());
+  }
+
+  static void print_report(const stall_report &report) {
+    std::cerr << "evtlet: fiber " << report.fiber << " ("
+              << (report.tag ? boost::core::demangle(report.tag) : "untagged")
+              << ") on thread " << report.thread << " running for "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     report.elapsed)
+                     .count()
+              << "us without yielding" << std::endl;
+  }
+
+protected:
+  void watch() {
+    std::unique_lock<std::mutex> lck(m_lock);
+    while (!m_stopped) {
+      m_cond.wait_for(lck, m_period);
+      const int64_t now = stall_slot::now_ns();
+      for (auto &slot : m_slots) {
+        // a test racing with a context switch may see the time when the
+        // previous fiber was resumed, with the identity of the next. Either
+        // way, some fiber on the thread has run past the budget.
+        const int64_t started =
+            slot->m_started.load(std::memory_order_acquire);
+        const uint64_t seq = slot->m_seq.load(std::memory_order_relaxed);
+        if (!started || seq == slot->m_reported_seq ||
+            now - started <= m_budget.count()) {
+          continue;
+        }
+        slot->m_reported_seq = seq;
+        slot->m_yield.store(true, std::memory_order_relaxed);
+        const stall_report report{
+            slot->m_thread, slot->m_fiber.load(std::memory_order_relaxed),
+            slot->m_tag.load(std::memory_order_relaxed),
+            duration_t(now - started)};
+        m_nreported.fetch_add(1);
+        m_report(report);
+      }
+    }
+  }
+};
+
+/**
+ * @brief scheduler algorithm `Algo`, with each context switch stamped for
+ * a `stall_watchdog`
+ *
+ * __Example:__ for a thread running `boost::fibers::algo::round_robin`
+ *
+ * ```cpp
+ * auto watchdog = std::make_shared<evtlet::stall_watchdog>(10ms);
+ * boost::fibers::use_scheduling_algorithm<
+ *     evtlet::stall_watched<boost::fibers::algo::round_robin>>(watchdog);
+ * ```
+ *
+ * Event tags will be reported for fibers having `evt_props`, i.e with an
+ * `Algo` such as `priority_scheduler`.
+ *
+ * @tparam Algo scheduler algorithm type
+ */
+template <typename Algo> class stall_watched : public Algo {
+private:
+  const std::shared_ptr<stall_watchdog> m_watchdog;
+  const std::shared_ptr<stall_slot> m_slot;
+
+public:
+  template <typename... Args>
+  explicit stall_watched(std::shared_ptr<stall_watchdog> watchdog,
+                         Args &&...args)
+      : Algo(std::forward<Args>(args)...), m_watchdog(std::move(watchdog)),
+        m_slot(m_watchdog->attach()) {
+    stall_slot::current() = m_slot.get();
+  }
+
+  virtual ~stall_watched() {
+    stall_slot::current() = nullptr;
+    m_watchdog->detach(m_slot);
+  }
+
+  boost::fibers::context *pick_next() noexcept override {
+    boost::fibers::context *ctx = Algo::pick_next();
+    m_slot->stamp(ctx);
+    return ctx;
+  }
+};
+
+/**
+ * @brief cooperative preemption point for long-running fibers
+ *
+ * Yields only when a `stall_watchdog` has found the calling fiber running
+ * past its budget. Otherwise, this tests one per-thread flag, such that it
+ * may be called within tight loops.
+ *
+ * @return true if the fiber yielded
+ */
+inline bool maybe_yield() {
+  stall_slot *slot = stall_slot::current();
+  if (slot && slot->take_yield()) {
+    boost::this_fiber::yield();
+    return true;
+  }
+  return false;
+}
+
+} // namespace evtlet
@@ -0,0 +1,227 @@
+/**
+ * @file virtual_time.hpp
+ * @brief deterministic scheduler algorithm with virtual time, for
+ * simulation
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/util/clock.hpp>
+#include <evtlet/util/dbg.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief scheduler algorithm for simulations in virtual time
+ *
+ * Fibers sleeping with `vsleep_for()` or `vsleep_until()` will be queued
+ * on the scheduler's own timers. Virtual time will advance only when no
+ * fiber is ready, and then directly to the earliest timer. Thus, a
+ * simulation will run as fast as its fibers can compute.
+ *
+ * Deadlines for standard timed waits, e.g `boost::this_fiber::sleep_for()`
+ * or a condition variable with a timeout, are ordered with the virtual
+ * timers: a virtual timer due before the earliest such deadline, measured
+ * from the current virtual time, will be run first. While blocked for a
+ * standard deadline, virtual time will advance with the real time.
+ *
+ * Each ready fiber will be chosen with a pseudo-random generator seeded
+ * at construction. For a program that does not depend on other threads or
+ * on real time, the order in which fibers run is then reproducible from
+ * the seed alone.
+ *
+ * While installed, `evtlet::clock::now()` will return the virtual time on
+ * the scheduler's thread. The virtual time starts at the real time of
+ * construction.
+ *
+ * For simulated network I/O, `loopback_stream` will deliver data after
+ * a latency in virtual time.
+ *
+ * __Known Limitations:__ Only the scheduler's own timers are skipped in
+ * virtual time. boost.fiber compares standard deadlines with
+ * `std::chrono::steady_clock`, such that a standard timed wait will still
+ * take its real duration. Likewise, `fd_stream` will poll its descriptor
+ * in real time. `real_waits()` will indicate whether a simulation has
+ * waited in real time. The scheduler supports only fibers on one thread.
+ */
+class virtual_scheduler : public boost::fibers::algo::algorithm {
+public:
+  using context_t = boost::fibers::context;
+  using time_point = clock::time_point;
+  using duration = clock::duration;
+
+private:
+  struct timer {
+    time_point at;
+    uint64_t seq;
+    context_t *ctx;
+
+    bool operator>(const timer &other) const noexcept {
+      return at != other.at ? at > other.at : seq > other.seq;
+    }
+  };
+
+  std::vector<context_t *> m_ready;
+  std::priority_queue<timer, std::vector<timer>, std::greater<timer>>
+      m_timers;
+  std::mt19937_64 m_rng;
+  uint64_t m_seq;
+  clock_cache_scope m_scope;
+  time_point m_now;
+  size_t m_nadvance;
+  size_t m_nreal;
+  std::mutex m_mtx;
+  std::condition_variable m_cnd;
+  bool m_flag;
+
+  static virtual_scheduler *&_current() noexcept {
+    static thread_local virtual_scheduler *sched = nullptr;
+    return sched;
+  }
+
+public:
+  explicit virtual_scheduler(uint64_t seed = 0)
+      : m_ready(), m_timers(), m_rng(seed), m_seq(0), m_scope(),
+        m_now(clock::now()), m_nadvance(0), m_nreal(0), m_mtx(), m_cnd(),
+        m_flag(false) {
+    _current() = this;
+  }
+
+  virtual ~virtual_scheduler() { _current() = nullptr; }
+
+  /// not copyable
+  virtual_scheduler(virtual_scheduler const &) = delete;
+
+  /// not assignable
+  virtual_scheduler &operator=(virtual_scheduler const &) = delete;
+
+  /// the scheduler for the calling thread, or nullptr
+  static virtual_scheduler *current() noexcept { return _current(); }
+
+  /// the virtual time
+  time_point now() const noexcept { return m_now; }
+
+  /// number of times virtual time has advanced
+  size_t advanced() const noexcept { return m_nadvance; }
+
+  /// number of times the scheduler has blocked for a standard deadline
+  size_t real_waits() const noexcept { return m_nreal; }
+
+  /// suspend the calling fiber until the virtual time `tp`
+  void sleep_until(time_point tp) {
+    context_t *ctx = context_t::active();
+    m_timers.push(timer{tp < m_now ? m_now : tp, m_seq++, ctx});
+    ctx->suspend();
+  }
+
+  void awakened(context_t *ctx) noexcept override { m_ready.push_back(ctx); }
+
+  context_t *pick_next() noexcept override {
+    if (m_ready.empty()) {
+      return nullptr;
+    }
+    const size_t nn = m_ready.size();
+    const size_t idx = nn > 1 ? static_cast<size_t>(m_rng() % nn) : 0;
+    context_t *ctx = m_ready[idx];
+    // the order of the remaining fibers is not significant
+    m_ready[idx] = m_ready.back();
+    m_ready.pop_back();
+    return ctx;
+  }
+
+  bool has_ready_fibers() const noexcept override { return !m_ready.empty(); }
+
+  void suspend_until(
+      std::chrono::steady_clock::time_point const &abs_time) noexcept override {
+    // no fiber is ready. `abs_time` is the earliest standard deadline
+    const bool unbounded =
+        (std::chrono::steady_clock::time_point::max)() == abs_time;
+    const auto start = std::chrono::steady_clock::now();
+    if (!m_timers.empty() &&
+        (unbounded || m_timers.top().at - m_now <= abs_time - start)) {
+      // the earliest virtual timer is due first
+      advance();
+      return;
+    }
+    // fibers may yet be woken from other threads or by a standard deadline
+    std::unique_lock<std::mutex> lck(m_mtx);
+    if (unbounded) {
+      m_cnd.wait(lck, [this]() { return m_flag; });
+    } else {
+      ++m_nreal;
+      m_cnd.wait_until(lck, abs_time, [this]() { return m_flag; });
+    }
+    m_flag = false;
+    lck.unlock();
+    if (!unbounded) {
+      // advance with the real time, not beyond the earliest virtual timer
+      duration waited = std::chrono::duration_cast<duration>(
+          std::chrono::steady_clock::now() - start);
+      if (!m_timers.empty() && m_timers.top().at - m_now < waited) {
+        waited = m_timers.top().at - m_now;
+      }
+      m_now += waited;
+      clock::set(m_now);
+    }
+  }
+
+  void notify() noexcept override {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    m_flag = true;
+    lck.unlock();
+    m_cnd.notify_all();
+  }
+
+protected:
+  /// advance to the earliest timer, making each fiber due at that time ready
+  void advance() {
+    ASSERT(!m_timers.empty());
+    m_now = m_timers.top().at;
+    ++m_nadvance;
+    clock::set(m_now);
+    while (!m_timers.empty() && !(m_now < m_timers.top().at)) {
+      m_ready.push_back(m_timers.top().ctx);
+      m_timers.pop();
+    }
+  }
+};
+
+/**
+ * @brief suspend the calling fiber until `tp`
+ *
+ * Under a `virtual_scheduler`, this will wait in virtual time. Otherwise,
+ * this will sleep until the corresponding real time.
+ */
+inline void vsleep_until(clock::time_point tp) {
+  if (virtual_scheduler *sched = virtual_scheduler::current()) {
+    sched->sleep_until(tp);
+  } else {
+    boost::this_fiber::sleep_until(clock::to_steady(tp));
+  }
+}
+
+/// suspend the calling fiber for `dur`, in virtual time if available
+template <typename Rep, typename Period>
+void vsleep_for(std::chrono::duration<Rep, Period> const &dur) {
+  vsleep_until(clock::now() +
+               std::chrono::duration_cast<clock::duration>(dur));
+}
+
+} // namespace evtlet
@@ -0,0 +1,222 @@
+/**
+ * @file worker_pool.hpp
+ * @brief multi-threaded runtime for boost.fiber, with a work-stealing
+ * scheduler algorithm
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+// cf. boost libs/fiber/examples/work_stealing.cpp
+
+#pragma once
+
+#include <barrier>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/rt/evt_work_stealing.hpp>
+#include <evtlet/rt/stall_watch.hpp>
+#include <evtlet/util/dbg.hpp>
+#include <evtlet/util/numa.hpp>
+
+namespace evtlet {
+
+enum class placement : size_t {
+  /// no thread affinity, stealing from any worker
+  PLACE_NONE = 0,
+  /// pin each worker thread to the CPUs of one NUMA node
+  PLACE_PIN = 1,
+  /// steal from workers on the same NUMA node, before other nodes
+  PLACE_LOCAL_STEAL = 2,
+  PLACE_NUMA = PLACE_PIN | PLACE_LOCAL_STEAL
+};
+
+/**
+ * @brief pool of worker threads sharing fibers via work stealing
+ *
+ * The thread constructing the pool will be counted as one of the pool's
+ * workers. The `evt_work_stealing` algorithm will be installed for that
+ * thread and for each additional worker thread, such that any fiber
+ * launched on one of these threads may be run by any other worker in the
+ * pool.
+ *
+ * With NUMA placement, the additional worker threads will be spread in
+ * contiguous blocks across the NUMA nodes available to the process, and
+ * each will have its node set as the `numa_thread_node()` hint, e.g for
+ * `numa_stack`. With `PLACE_PIN`, each additional worker will be pinned to
+ * the CPUs of its node. The constructing thread is not pinned, and is not
+ * counted in the node assignment. Its node is the node it was running on
+ * when the pool was created. On a host with one node, this is equivalent
+ * to `PLACE_NONE`, except for CPU affinity.
+ *
+ * With a `stall_watchdog`, every worker thread will be watched for fibers
+ * running past the watchdog's budget.
+ *
+ * The pool must be created before any fiber is launched on the constructing
+ * thread, and must be destroyed on that thread, once all work in the pool
+ * has completed.
+ */
+class worker_pool {
+public:
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+  using task_t = std::function<void()>;
+
+private:
+  const size_t m_nthreads;
+  const std::shared_ptr<steal_registry> m_registry;
+  std::vector<std::thread> m_workers;
+  std::barrier<> m_sync;
+  lock_t m_lock;
+  cond_t m_cond;
+  std::vector<std::deque<task_t>> m_posted;
+  bool m_stopped;
+
+public:
+  /**
+   * @param nthreads number of worker threads, including the calling thread
+   * @param suspend if true, idle workers will sleep rather than spinning
+   *        for work to steal
+   * @param place thread placement and stealing policy
+   * @param watchdog optional watchdog for stalled fibers
+   */
+  explicit worker_pool(size_t nthreads = std::thread::hardware_concurrency(),
+                       bool suspend = false,
+                       placement place = placement::PLACE_NONE,
+                       std::shared_ptr<stall_watchdog> watchdog = nullptr)
+      : m_nthreads(nthreads ? nthreads : 1),
+        m_registry(std::make_shared<steal_registry>(m_nthreads)), m_workers(),
+        m_sync(static_cast<std::ptrdiff_t>(m_nthreads)), m_lock(), m_cond(),
+        m_posted(m_nthreads), m_stopped(false) {
+    const bool pin = static_cast<size_t>(place) &
+                     static_cast<size_t>(placement::PLACE_PIN);
+    const bool prefer_local =
+        static_cast<size_t>(place) &
+        static_cast<size_t>(placement::PLACE_LOCAL_STEAL);
+    const auto nodes = numa_topology();
+
+    // every scheduler must be registered with the algorithm before any
+    // worker may attempt to steal from it
+    m_workers.reserve(m_nthreads - 1);
+    for (size_t ii = 1; ii < m_nthreads; ++ii) {
+      // the constructing thread, unpinned, is excluded from the assignment
+      const numa_node &node =
+          nodes[(ii - 1) * nodes.size() / (m_nthreads - 1)];
+      m_workers.emplace_back([this, ii, node, pin, suspend, prefer_local,
+                              watchdog]() {
+        if (pin) {
+          static_cast<void>(numa_pin_thread(node.cpus));
+          numa_thread_node() = node.id;
+        }
+        use_algorithm(watchdog, ii, node.id, suspend, prefer_local);
+        m_sync.arrive_and_wait();
+        worker_main(ii);
+      });
+    }
+    // the affinity of the constructing thread is left to the caller
+    const int node0 = numa_current_node(nodes);
+    if (pin) {
+      numa_thread_node() = node0;
+    }
+    use_algorithm(watchdog, 0, node0, suspend, prefer_local);
+    m_sync.arrive_and_wait();
+  }
+
+  virtual ~worker_pool() {
+    stop();
+    for (auto &thr : m_workers) {
+      if (thr.joinable()) {
+        thr.join();
+      }
+    }
+    // the constructing thread will continue with only its own ready queue
+    m_registry->close();
+  }
+
+  /// not copyable
+  worker_pool(worker_pool const &) = delete;
+
+  /// not assignable
+  worker_pool &operator=(worker_pool const &) = delete;
+
+  /// number of threads in the pool, including the constructing thread
+  size_t size() const noexcept { return m_nthreads; }
+
+  /// NUMA node for a worker thread, or zero if not known
+  int node_of(size_t worker) const noexcept {
+    return m_registry->node_of(worker);
+  }
+
+  /**
+   * @brief launch a detached fiber for `task`, on a worker thread
+   *
+   * The fiber will be launched by the worker thread, such that it will be
+   * queued first on that worker's node. It may later be stolen by other
+   * workers.
+   *
+   * @param worker index of a worker thread, in `[1, size())`. The
+   *        constructing thread, at index zero, does not accept posted tasks.
+   */
+  void post(size_t worker, task_t &&task) {
+    ASSERT(worker > 0 && worker < m_nthreads);
+    std::unique_lock<lock_t> lck(m_lock);
+    m_posted[worker].emplace_back(std::move(task));
+    lck.unlock();
+    m_cond.notify_all();
+  }
+
+  /// release the worker threads, once their fibers have completed
+  void stop() {
+    std::unique_lock<lock_t> lck(m_lock);
+    m_stopped = true;
+    lck.unlock();
+    m_cond.notify_all();
+  }
+
+private:
+  void use_algorithm(const std::shared_ptr<stall_watchdog> &watchdog,
+                     size_t worker, int node, bool suspend,
+                     bool prefer_local) {
+    if (watchdog) {
+      boost::fibers::use_scheduling_algorithm<
+          stall_watched<evt_work_stealing>>(watchdog, m_registry, worker,
+                                            node, suspend, prefer_local);
+    } else {
+      boost::fibers::use_scheduling_algorithm<evt_work_stealing>(
+          m_registry, worker, node, suspend, prefer_local);
+    }
+  }
+
+  void worker_main(size_t worker) {
+    // the main fiber of each worker thread will wait here, while the
+    // dispatcher fiber for the thread runs any fibers stolen from the pool
+    std::unique_lock<lock_t> lck(m_lock);
+    auto &posted = m_posted[worker];
+    while (true) {
+      while (!m_stopped && posted.empty()) {
+        m_cond.wait(lck);
+      }
+      if (posted.empty()) {
+        break;
+      }
+      task_t task = std::move(posted.front());
+      posted.pop_front();
+      lck.unlock();
+      boost::fibers::fiber(std::move(task)).detach();
+      lck.lock();
+    }
+  }
+};
+
+} // namespace evtlet
@@ -0,0 +1,60 @@
+/**
+ * @file adaptive_mutex.hpp
+ * @brief fiber mutex, spinning briefly before parking
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/sync/spin_wait.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief fiber mutex, spinning briefly before parking
+ *
+ * `lock()` will first attempt `try_lock()` up to the spin limit, yielding
+ * between attempts, before parking the calling fiber on the underlying
+ * `boost::fibers::mutex`. For very short critical sections, this may avoid
+ * a full round trip through the scheduler.
+ *
+ * This may be used as the `condition_lock_t` for `evt_fiber`, together
+ * with `adaptive_condition` as the `condition_t`.
+ */
+class adaptive_mutex {
+private:
+  boost::fibers::mutex m_lock;
+  const size_t m_spin_limit;
+
+public:
+  explicit adaptive_mutex(size_t spin_limit = default_spin_limit)
+      : m_lock(), m_spin_limit(spin_limit) {}
+
+  /// not copyable
+  adaptive_mutex(adaptive_mutex const &) = delete;
+
+  /// not assignable
+  adaptive_mutex &operator=(adaptive_mutex const &) = delete;
+
+  void lock() {
+    if (!spin_until([this]() { return m_lock.try_lock(); }, m_spin_limit)) {
+      m_lock.lock();
+    }
+  }
+
+  bool try_lock() { return m_lock.try_lock(); }
+
+  void unlock() { m_lock.unlock(); }
+};
+
+/// condition variable for use with adaptive_mutex
+using adaptive_condition = boost::fibers::condition_variable_any;
+
+} // namespace evtlet
@@ -0,0 +1,112 @@
+/**
+ * @file fiber_mask.hpp
+ * @brief atomic bitmask state, with waiting fibers parked on a condition
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/sync/spin_wait.hpp>
+#include <evtlet/util/mask.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief `atomic_mask` for waiting fibers
+ *
+ * Transitions are applied to an `atomic_mask`, without locking. A fiber in
+ * `wait()` will spin briefly, then park on a fiber condition variable,
+ * such that other fibers on the waiting thread may continue to run. The
+ * internal lock is used only while some fiber is parked.
+ *
+ * As with `atomic_mask`, a transition will not wake any waiter until
+ * `notify_all()` or `notify_one()` is called.
+ */
+template <typename E> class fiber_mask {
+public:
+  using value_type = E;
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+
+private:
+  atomic_mask<E> m_mask;
+  std::atomic<size_t> m_waiters;
+  lock_t m_lock;
+  cond_t m_cond;
+  const size_t m_spin_limit;
+
+public:
+  explicit fiber_mask(E value, size_t spin_limit = default_spin_limit)
+      : m_mask(value), m_waiters(0), m_lock(), m_cond(),
+        m_spin_limit(spin_limit) {}
+
+  /// not copyable
+  fiber_mask(fiber_mask const &) = delete;
+
+  /// not assignable
+  fiber_mask &operator=(fiber_mask const &) = delete;
+
+  /// the atomic value, e.g for transitions with a specific memory order
+  atomic_mask<E> &mask() noexcept { return m_mask; }
+
+  E load() const noexcept { return m_mask.load(); }
+
+  void store(E value) noexcept { m_mask.store(value); }
+
+  E exchange(E value) noexcept { return m_mask.exchange(value); }
+
+  E fetch_or(E bits) noexcept { return m_mask.fetch_or(bits); }
+
+  E fetch_and(E bits) noexcept { return m_mask.fetch_and(bits); }
+
+  E fetch_xor(E bits) noexcept { return m_mask.fetch_xor(bits); }
+
+  bool compare_exchange_strong(E &expected, E desired) noexcept {
+    return m_mask.compare_exchange_strong(expected, desired);
+  }
+
+  bool test(E bits) const noexcept { return m_mask.test(bits); }
+
+  bool test_any(E bits) const noexcept { return m_mask.test_any(bits); }
+
+  /// block the calling fiber while the value is equal to `old`
+  void wait(E old) {
+    if (spin_until([this, old]() { return m_mask.load() != old; },
+                   m_spin_limit)) {
+      return;
+    }
+    std::unique_lock<lock_t> lck(m_lock);
+    // the waiter count is published before testing the value again, such
+    // that a concurrent notify will see either the waiter or the new value
+    m_waiters.fetch_add(1);
+    while (m_mask.load() == old) {
+      m_cond.wait(lck);
+    }
+    m_waiters.fetch_sub(1);
+  }
+
+  void notify_one() {
+    if (m_waiters.load()) {
+      std::unique_lock<lock_t> lck(m_lock);
+      m_cond.notify_one();
+    }
+  }
+
+  void notify_all() {
+    if (m_waiters.load()) {
+      std::unique_lock<lock_t> lck(m_lock);
+      m_cond.notify_all();
+    }
+  }
+};
+
+} // namespace evtlet
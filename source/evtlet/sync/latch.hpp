@@ -0,0 +1,150 @@
+/**
+ * @file latch.hpp
+ * @brief fiber latch and barrier, spinning briefly before parking
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/sync/spin_wait.hpp>
+#include <evtlet/util/dbg.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief single-use countdown for fibers, after `std::latch`
+ *
+ * The last update to the count is made while locked, and `wait()` will
+ * acquire the lock before returning, such that a fiber may destroy the
+ * latch once `wait()` has returned. A fiber destroying the latch after
+ * `try_wait()` returns true should call `wait()` first.
+ */
+class latch {
+public:
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+
+private:
+  std::atomic<ptrdiff_t> m_count;
+  lock_t m_lock;
+  cond_t m_cond;
+  const size_t m_spin_limit;
+
+public:
+  explicit latch(ptrdiff_t count, size_t spin_limit = default_spin_limit)
+      : m_count(count), m_lock(), m_cond(), m_spin_limit(spin_limit) {
+    ASSERT(count >= 0);
+  }
+
+  /// not copyable
+  latch(latch const &) = delete;
+
+  /// not assignable
+  latch &operator=(latch const &) = delete;
+
+  void count_down(ptrdiff_t update = 1) {
+    ptrdiff_t cur = m_count.load(std::memory_order_relaxed);
+    while (cur > update) {
+      if (m_count.compare_exchange_weak(cur, cur - update,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    std::unique_lock<lock_t> lck(m_lock);
+    const ptrdiff_t prev = m_count.fetch_sub(update, std::memory_order_release);
+    ASSERT(prev == update);
+    m_cond.notify_all();
+  }
+
+  bool try_wait() const noexcept {
+    return m_count.load(std::memory_order_acquire) == 0;
+  }
+
+  void wait() {
+    const bool spun =
+        spin_until([this]() { return try_wait(); }, m_spin_limit);
+    // once locked, the last count_down() will have released the latch
+    std::unique_lock<lock_t> lck(m_lock);
+    while (!spun && !try_wait()) {
+      m_cond.wait(lck);
+    }
+  }
+
+  void arrive_and_wait(ptrdiff_t update = 1) {
+    count_down(update);
+    wait();
+  }
+};
+
+/**
+ * @brief reusable barrier for a fixed number of fibers, after `std::barrier`
+ *
+ * The phase is advanced while locked, and each fiber will acquire the lock
+ * before returning from `arrive_and_wait()`, such that the barrier may be
+ * destroyed once every fiber has returned for the last phase.
+ */
+class barrier {
+public:
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+
+private:
+  const size_t m_count;
+  size_t m_pending;
+  std::atomic<size_t> m_phase;
+  lock_t m_lock;
+  cond_t m_cond;
+  const size_t m_spin_limit;
+
+public:
+  explicit barrier(size_t count, size_t spin_limit = default_spin_limit)
+      : m_count(count), m_pending(count), m_phase(0), m_lock(), m_cond(),
+        m_spin_limit(spin_limit) {
+    ASSERT(count > 0);
+  }
+
+  /// not copyable
+  barrier(barrier const &) = delete;
+
+  /// not assignable
+  barrier &operator=(barrier const &) = delete;
+
+  /**
+   * @brief wait for all fibers to arrive for the current phase
+   *
+   * @return true for exactly one of the fibers arriving in each phase
+   */
+  bool arrive_and_wait() {
+    std::unique_lock<lock_t> lck(m_lock);
+    const size_t phase = m_phase.load(std::memory_order_relaxed);
+    if (--m_pending == 0) {
+      m_pending = m_count;
+      m_phase.store(phase + 1, std::memory_order_release);
+      m_cond.notify_all();
+      return true;
+    }
+    lck.unlock();
+    const auto released = [this, phase]() {
+      return m_phase.load(std::memory_order_acquire) != phase;
+    };
+    const bool spun = spin_until(released, m_spin_limit);
+    // once locked, the last fiber to arrive will have released the barrier
+    lck.lock();
+    while (!spun && !released()) {
+      m_cond.wait(lck);
+    }
+    return false;
+  }
+};
+
+} // namespace evtlet
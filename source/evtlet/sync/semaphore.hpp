@@ -0,0 +1,113 @@
+/**
+ * @file semaphore.hpp
+ * @brief fiber counting semaphore, spinning briefly before parking
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/sync/spin_wait.hpp>
+#include <evtlet/util/dbg.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief fiber counting semaphore, spinning briefly before parking
+ *
+ * The count is held in an atomic, such that `try_acquire()` and an
+ * uncontended `release()` will not lock. The internal lock is used only
+ * while some fiber is parked in `acquire()`.
+ *
+ * __Example:__ limiting the number of concurrent calls to a backend
+ *
+ * ```cpp
+ * evtlet::semaphore limit(8);
+ * // ... in each fiber
+ * limit.acquire();
+ * SCOPE_EXIT guard{[&limit]() { limit.release(); }};
+ * call_backend();
+ * ```
+ */
+class semaphore {
+public:
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+
+private:
+  std::atomic<ptrdiff_t> m_count;
+  std::atomic<size_t> m_waiters;
+  lock_t m_lock;
+  cond_t m_cond;
+  const size_t m_spin_limit;
+
+public:
+  explicit semaphore(ptrdiff_t count, size_t spin_limit = default_spin_limit)
+      : m_count(count), m_waiters(0), m_lock(), m_cond(),
+        m_spin_limit(spin_limit) {
+    ASSERT(count >= 0);
+  }
+
+  /// not copyable
+  semaphore(semaphore const &) = delete;
+
+  /// not assignable
+  semaphore &operator=(semaphore const &) = delete;
+
+  bool try_acquire() noexcept {
+    // the count is loaded in sequential order with the waiter count, for
+    // the handshake with release() in acquire()
+    ptrdiff_t cur = m_count.load(std::memory_order_seq_cst);
+    while (cur > 0) {
+      if (m_count.compare_exchange_weak(cur, cur - 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_seq_cst)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void acquire() {
+    if (spin_until([this]() { return try_acquire(); }, m_spin_limit)) {
+      return;
+    }
+    std::unique_lock<lock_t> lck(m_lock);
+    // the waiter count is published before testing the count again, such
+    // that a concurrent release() will see either the waiter or the
+    // updated count
+    m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    while (!try_acquire()) {
+      m_cond.wait(lck);
+    }
+    m_waiters.fetch_sub(1);
+  }
+
+  void release(ptrdiff_t update = 1) {
+    ASSERT(update >= 0);
+    m_count.fetch_add(update, std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_seq_cst)) {
+      std::unique_lock<lock_t> lck(m_lock);
+      if (update == 1) {
+        m_cond.notify_one();
+      } else {
+        m_cond.notify_all();
+      }
+    }
+  }
+
+  /// the count at the instant of the call
+  ptrdiff_t available() const noexcept {
+    return m_count.load(std::memory_order_relaxed);
+  }
+};
+
+} // namespace evtlet
@@ -0,0 +1,119 @@
+/**
+ * @file shared_mutex.hpp
+ * @brief fiber reader-writer lock, spinning briefly before parking
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+
+#include <evtlet/sync/spin_wait.hpp>
+#include <evtlet/util/dbg.hpp>
+
+namespace evtlet {
+
+/**
+ * @brief fiber reader-writer lock, spinning briefly before parking
+ *
+ * Satisfies the standard _SharedMutex_ requirements, such that it can be
+ * used with `std::unique_lock` and `std::shared_lock`.
+ *
+ * Writers are preferred: once a writer is waiting, no further reader will
+ * acquire the lock until the writer has released it.
+ */
+class shared_mutex {
+public:
+  using lock_t = boost::fibers::mutex;
+  using cond_t = boost::fibers::condition_variable;
+
+private:
+  lock_t m_lock;
+  cond_t m_read_cond;
+  cond_t m_write_cond;
+  size_t m_readers;
+  size_t m_writers_waiting;
+  bool m_writer;
+  const size_t m_spin_limit;
+
+public:
+  explicit shared_mutex(size_t spin_limit = default_spin_limit)
+      : m_lock(), m_read_cond(), m_write_cond(), m_readers(0),
+        m_writers_waiting(0), m_writer(false), m_spin_limit(spin_limit) {}
+
+  /// not copyable
+  shared_mutex(shared_mutex const &) = delete;
+
+  /// not assignable
+  shared_mutex &operator=(shared_mutex const &) = delete;
+
+  bool try_lock() {
+    std::unique_lock<lock_t> lck(m_lock);
+    if (m_writer || m_readers) {
+      return false;
+    }
+    m_writer = true;
+    return true;
+  }
+
+  void lock() {
+    if (spin_until([this]() { return try_lock(); }, m_spin_limit)) {
+      return;
+    }
+    std::unique_lock<lock_t> lck(m_lock);
+    ++m_writers_waiting;
+    while (m_writer || m_readers) {
+      m_write_cond.wait(lck);
+    }
+    --m_writers_waiting;
+    m_writer = true;
+  }
+
+  void unlock() {
+    std::unique_lock<lock_t> lck(m_lock);
+    ASSERT(m_writer);
+    m_writer = false;
+    if (m_writers_waiting) {
+      m_write_cond.notify_one();
+    } else {
+      m_read_cond.notify_all();
+    }
+  }
+
+  bool try_lock_shared() {
+    std::unique_lock<lock_t> lck(m_lock);
+    if (m_writer || m_writers_waiting) {
+      return false;
+    }
+    ++m_readers;
+    return true;
+  }
+
+  void lock_shared() {
+    if (spin_until([this]() { return try_lock_shared(); }, m_spin_limit)) {
+      return;
+    }
+    std::unique_lock<lock_t> lck(m_lock);
+    while (m_writer || m_writers_waiting) {
+      m_read_cond.wait(lck);
+    }
+    ++m_readers;
+  }
+
+  void unlock_shared() {
+    std::unique_lock<lock_t> lck(m_lock);
+    ASSERT(m_readers);
+    --m_readers;
+    if (!m_readers && m_writers_waiting) {
+      m_write_cond.notify_one();
+    }
+  }
+};
+
+} // namespace evtlet
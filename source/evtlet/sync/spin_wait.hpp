@@ -0,0 +1,39 @@
+/**
+ * @file spin_wait.hpp
+ * @brief bounded spinning for fiber-aware synchronization
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <boost/fiber/operations.hpp>
+
+namespace evtlet {
+
+/// default number of attempts before a fiber will park
+constexpr size_t default_spin_limit = 64;
+
+/**
+ * @brief test `pred()` up to `limit` times, yielding between attempts
+ *
+ * Each yield allows other ready fibers on the same thread to run, e.g a
+ * fiber holding the resource being waited for. When no other fiber is
+ * ready, the yield will return immediately.
+ *
+ * @return true if `pred()` was satisfied, false if the caller should park
+ */
+template <typename Pred> bool spin_until(Pred &&pred, size_t limit) {
+  for (size_t ii = 0; ii < limit; ++ii) {
+    if (pred()) {
+      return true;
+    }
+    boost::this_fiber::yield();
+  }
+  return pred();
+}
+
+} // namespace evtlet
@@ -0,0 +1,138 @@
+/**
+ * @file clock.hpp
+ * @brief std::chrono clock with a per-thread cached time
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+// On some virtualized hosts, clock_gettime() cannot use the vDSO and will
+// fall back to a system call. cf. Bert Hubert, "On Linux vDSO and
+// clock_gettime sometimes being slow"
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <time.h>
+
+namespace evtlet {
+
+class clock_cache_scope;
+
+/**
+ * @brief std::chrono clock, returning a cached time within an event loop
+ *
+ * On a thread within a `clock_cache_scope`, e.g a thread running an event
+ * loop with an `ev_clock`, `now()` will return the time cached at the
+ * latest `update()`, typically once per loop iteration. Otherwise, `now()`
+ * will read the coarse monotonic clock, which will not enter the kernel.
+ *
+ * Time points have the epoch of `CLOCK_MONOTONIC`. Since the cached time
+ * may lag the coarse clock, this clock is not declared steady. Within one
+ * thread, `now()` will not decrease while the cache is in use.
+ */
+class clock {
+public:
+  using duration = std::chrono::nanoseconds;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::time_point<clock, duration>;
+
+  static constexpr bool is_steady = false;
+
+private:
+  struct cache_t {
+    int64_t ns;
+    size_t depth;
+  };
+
+  static cache_t &_cache() noexcept {
+    static thread_local cache_t cache{0, 0};
+    return cache;
+  }
+
+  static time_point _read(clockid_t id) noexcept {
+    struct timespec ts;
+    ::clock_gettime(id, &ts);
+    return time_point(duration(static_cast<int64_t>(ts.tv_sec) * 1000000000 +
+                               static_cast<int64_t>(ts.tv_nsec)));
+  }
+
+  friend class clock_cache_scope;
+
+public:
+  /// the cached time on this thread, else the coarse monotonic time
+  static time_point now() noexcept {
+    const cache_t &cache = _cache();
+    return cache.depth ? time_point(duration(cache.ns)) : coarse_now();
+  }
+
+  /// the monotonic time, read from the system
+  static time_point precise_now() noexcept { return _read(CLOCK_MONOTONIC); }
+
+  /// the monotonic time, at the resolution of the scheduler tick
+  static time_point coarse_now() noexcept {
+#ifdef CLOCK_MONOTONIC_COARSE
+    return _read(CLOCK_MONOTONIC_COARSE);
+#else
+    return _read(CLOCK_MONOTONIC);
+#endif
+  }
+
+  /// true if `now()` will return the cached time on this thread
+  static bool cached() noexcept { return _cache().depth > 0; }
+
+  /// refresh the cached time for this thread from the system
+  static void update() noexcept { set(precise_now()); }
+
+  /**
+   * @brief set the cached time for this thread, e.g for virtual time
+   *
+   * The time will not be set earlier than the current cached time, within
+   * the outermost `clock_cache_scope`.
+   */
+  static void set(time_point tp) noexcept {
+    cache_t &cache = _cache();
+    const int64_t ns = tp.time_since_epoch().count();
+    if (ns > cache.ns) {
+      cache.ns = ns;
+    }
+  }
+
+  /// the `std::chrono::steady_clock` time corresponding to `tp`
+  static std::chrono::steady_clock::time_point to_steady(time_point tp) {
+    return std::chrono::steady_clock::now() +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+               tp - now());
+  }
+};
+
+/**
+ * @brief scope for the cached time on the current thread
+ *
+ * The time will be read from the system on entering the outermost scope
+ * for the thread, replacing any time cached within an earlier scope, e.g
+ * a virtual time. Scopes may be nested.
+ */
+class clock_cache_scope {
+public:
+  clock_cache_scope() noexcept {
+    clock::cache_t &cache = clock::_cache();
+    if (!cache.depth++) {
+      cache.ns = clock::precise_now().time_since_epoch().count();
+    }
+  }
+
+  ~clock_cache_scope() { --clock::_cache().depth; }
+
+  /// not copyable
+  clock_cache_scope(clock_cache_scope const &) = delete;
+
+  /// not assignable
+  clock_cache_scope &operator=(clock_cache_scope const &) = delete;
+};
+
+} // namespace evtlet
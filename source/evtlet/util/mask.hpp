@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <type_traits>
 
 /**
@@ -129,3 +130,137 @@ operator!(E lhs) {
     static constexpr bool enable = true;                                       \
   };
 #endif
+
+/**
+ * @brief atomic value for a bitmask enum type
+ * @tparam E enum type, with `enum_mask_t<E>::enable`
+ *
+ * Each transition is a single atomic operation on the underlying value, e.g
+ * `fetch_or()` to set bits, `fetch_and()` to clear bits, or
+ * `compare_exchange_strong()` for a conditional transition. As with
+ * `std::atomic`, each transition returns the previous value.
+ *
+ * `wait()` and `notify_all()` use `std::atomic::wait`, such that a waiting
+ * thread will block in the kernel, e.g on a futex. This will block every
+ * fiber on the waiting thread. Fibers should wait on a `fiber_mask` instead.
+ *
+ * __Example:__ completion signalling across threads
+ *
+ * ```cpp
+ * DEFMASK_T(job_t, size_t, JOB_NONE = 0, JOB_RUN = 1, JOB_DONE = 2);
+ * atomic_mask<job_t> state(job_t::JOB_RUN);
+ * // ... in the worker thread
+ * state.fetch_or(job_t::JOB_DONE);
+ * state.notify_all();
+ * // ... in the waiting thread
+ * for (auto st = state.load(); !(st & job_t::JOB_DONE); st = state.load()) {
+ *   state.wait(st);
+ * }
+ * ```
+ */
+template <typename E> class atomic_mask {
+  static_assert(enum_mask_t<E>::enable,
+                "atomic_mask requires an enum type defined with DEFMASK_T");
+
+public:
+  typedef E value_type;
+  typedef typename std::underlying_type<E>::type underlying;
+
+private:
+  std::atomic<underlying> m_bits;
+
+  static constexpr underlying bits_of(E value) noexcept {
+    return static_cast<underlying>(value);
+  }
+
+public:
+  constexpr atomic_mask() noexcept : m_bits(0) {}
+
+  constexpr explicit atomic_mask(E value) noexcept : m_bits(bits_of(value)) {}
+
+  /// not copyable
+  atomic_mask(atomic_mask const &) = delete;
+
+  /// not assignable
+  atomic_mask &operator=(atomic_mask const &) = delete;
+
+  E load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+    return static_cast<E>(m_bits.load(order));
+  }
+
+  void store(E value,
+             std::memory_order order = std::memory_order_seq_cst) noexcept {
+    m_bits.store(bits_of(value), order);
+  }
+
+  E exchange(E value,
+             std::memory_order order = std::memory_order_seq_cst) noexcept {
+    return static_cast<E>(m_bits.exchange(bits_of(value), order));
+  }
+
+  /// set `bits`, returning the previous value
+  E fetch_or(E bits,
+             std::memory_order order = std::memory_order_seq_cst) noexcept {
+    return static_cast<E>(m_bits.fetch_or(bits_of(bits), order));
+  }
+
+  /// clear every bit not in `bits`, returning the previous value
+  E fetch_and(E bits,
+              std::memory_order order = std::memory_order_seq_cst) noexcept {
+    return static_cast<E>(m_bits.fetch_and(bits_of(bits), order));
+  }
+
+  /// toggle `bits`, returning the previous value
+  E fetch_xor(E bits,
+              std::memory_order order = std::memory_order_seq_cst) noexcept {
+    return static_cast<E>(m_bits.fetch_xor(bits_of(bits), order));
+  }
+
+  /**
+   * @brief replace `expected` with `desired`
+   *
+   * On failure, `expected` will be updated to the current value.
+   */
+  bool compare_exchange_strong(
+      E &expected, E desired,
+      std::memory_order order = std::memory_order_seq_cst) noexcept {
+    underlying exp = bits_of(expected);
+    const bool rslt = m_bits.compare_exchange_strong(exp, bits_of(desired),
+                                                     order);
+    expected = static_cast<E>(exp);
+    return rslt;
+  }
+
+  /// compare_exchange_strong(), which may fail spuriously, e.g in a loop
+  bool compare_exchange_weak(
+      E &expected, E desired,
+      std::memory_order order = std::memory_order_seq_cst) noexcept {
+    underlying exp = bits_of(expected);
+    const bool rslt = m_bits.compare_exchange_weak(exp, bits_of(desired),
+                                                   order);
+    expected = static_cast<E>(exp);
+    return rslt;
+  }
+
+  /// true if every bit in `bits` is set
+  bool test(E bits, std::memory_order order =
+                        std::memory_order_seq_cst) const noexcept {
+    return (m_bits.load(order) & bits_of(bits)) == bits_of(bits);
+  }
+
+  /// true if any bit in `bits` is set
+  bool test_any(E bits, std::memory_order order =
+                            std::memory_order_seq_cst) const noexcept {
+    return (m_bits.load(order) & bits_of(bits)) != 0;
+  }
+
+  /// block the calling thread while the value is equal to `old`
+  void wait(E old, std::memory_order order =
+                       std::memory_order_seq_cst) const noexcept {
+    m_bits.wait(bits_of(old), order);
+  }
+
+  void notify_one() noexcept { m_bits.notify_one(); }
+
+  void notify_all() noexcept { m_bits.notify_all(); }
+};
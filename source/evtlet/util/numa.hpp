@@ -0,0 +1,209 @@
+/**
+ * @file numa.hpp
+ * @brief NUMA topology and memory placement, for Linux hosts
+ *
+ * @copyright Copyright (c) 2025 Sean Champ
+ *
+ */
+
+// This uses the sysfs node topology and the mbind(2) system call directly,
+// rather than libnuma. On any host without NUMA support, the topology will
+// be presented as a single node and memory placement will be a no-op.
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#endif
+
+namespace evtlet {
+
+/// a NUMA node and the CPUs available to this process on that node
+struct numa_node {
+  int id;
+  std::vector<int> cpus;
+};
+
+/**
+ * @brief parse a Linux CPU list, e.g `0-3,8-11,16`
+ *
+ * Malformed entries will be ignored.
+ */
+inline std::vector<int> parse_cpulist(std::string_view text) {
+  std::vector<int> cpus;
+  while (!text.empty()) {
+    const size_t comma = text.find(',');
+    std::string_view item = text.substr(0, comma);
+    text = comma == std::string_view::npos ? std::string_view()
+                                           : text.substr(comma + 1);
+    while (!item.empty() && (item.back() == '\n' || item.back() == ' ')) {
+      item.remove_suffix(1);
+    }
+    int first = 0, last = 0;
+    const char *end = item.data() + item.size();
+    auto rs = std::from_chars(item.data(), end, first);
+    if (rs.ec != std::errc() || first < 0) {
+      continue;
+    }
+    last = first;
+    if (rs.ptr != end && *rs.ptr == '-') {
+      rs = std::from_chars(rs.ptr + 1, end, last);
+      if (rs.ec != std::errc() || last < first) {
+        continue;
+      }
+    }
+    if (rs.ptr != end) {
+      continue;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+/// CPUs in the affinity mask for the calling thread
+inline std::vector<int> numa_allowed_cpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  if (cpus.empty()) {
+    const auto ncpu = std::max(1U, std::thread::hardware_concurrency());
+    for (unsigned cpu = 0; cpu < ncpu; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+/**
+ * @brief NUMA nodes having CPUs available to the calling thread
+ *
+ * Nodes are read from `/sys/devices/system/node`. If no node information
+ * is available, a single node 0 will be returned with every allowed CPU.
+ */
+inline std::vector<numa_node> numa_topology() {
+  const auto allowed = numa_allowed_cpus();
+  std::vector<numa_node> nodes;
+  std::error_code ec;
+  const std::filesystem::path base("/sys/devices/system/node");
+  for (const auto &entry : std::filesystem::directory_iterator(base, ec)) {
+    const std::string name = entry.path().filename().string();
+    int id = -1;
+    if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+        std::from_chars(name.data() + 4, name.data() + name.size(), id).ec !=
+            std::errc()) {
+      continue;
+    }
+    std::ifstream in(entry.path() / "cpulist");
+    std::string text;
+    std::getline(in, text);
+    numa_node node{id, {}};
+    for (int cpu : parse_cpulist(text)) {
+      if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+        node.cpus.push_back(cpu);
+      }
+    }
+    if (!node.cpus.empty()) {
+      nodes.emplace_back(std::move(node));
+    }
+  }
+  if (nodes.empty()) {
+    nodes.push_back(numa_node{0, allowed});
+  }
+  std::sort(nodes.begin(), nodes.end(),
+            [](const numa_node &lhs, const numa_node &rhs) {
+              return lhs.id < rhs.id;
+            });
+  return nodes;
+}
+
+/// the node for the CPU running the calling thread, or the first node
+inline int numa_current_node(const std::vector<numa_node> &nodes) {
+  const int cpu = ::sched_getcpu();
+  for (const auto &node : nodes) {
+    if (std::find(node.cpus.begin(), node.cpus.end(), cpu) !=
+        node.cpus.end()) {
+      return node.id;
+    }
+  }
+  return nodes.empty() ? 0 : nodes.front().id;
+}
+
+/**
+ * @brief node hint for the calling thread
+ *
+ * This will be set for each thread of a `worker_pool` with NUMA
+ * placement, and is otherwise -1.
+ */
+inline int &numa_thread_node() noexcept {
+  static thread_local int node = -1;
+  return node;
+}
+
+/// restrict the calling thread to a set of CPUs, returning false on failure
+inline bool numa_pin_thread(const std::vector<int> &cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+/**
+ * @brief prefer a NUMA node for the pages of a memory region
+ *
+ * The region should be page-aligned, e.g as returned by `mmap()`. Pages
+ * will be placed on the node when first touched.
+ *
+ * @return false if the policy could not be applied, e.g on a host without
+ *         NUMA support
+ */
+inline bool numa_bind(void *addr, size_t len, int node) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+  constexpr size_t mask_bits = 1024;
+  constexpr size_t word_bits = 8 * sizeof(unsigned long);
+  if (node < 0 || static_cast<size_t>(node) >= mask_bits) {
+    return false;
+  }
+  unsigned long mask[mask_bits / word_bits] = {};
+  const auto nn = static_cast<size_t>(node);
+  mask[nn / word_bits] = 1UL << (nn % word_bits);
+  // the kernel reads (maxnode - 1) bits of the mask
+  return ::syscall(SYS_mbind, addr, len, MPOL_PREFERRED, mask, mask_bits + 1,
+                   0) == 0;
+#else
+  static_cast<void>(addr);
+  static_cast<void>(len);
+  static_cast<void>(node);
+  return false;
+#endif
+}
+
+} // namespace evtlet
@@ -0,0 +1,184 @@
+"""tests for the evtlet Python module
+
+usage, with the module built for EVTLET_PYTHON:
+  $ PYTHONPATH=<build>/python python3 -m pytest tests/test_python_module.py
+"""
+
+import socket
+import traceback
+
+import pytest
+
+import evtlet
+
+
+def test_spawn_get():
+    task = evtlet.spawn(lambda a, b=0: a + b, 1, b=2)
+    assert task.get() == 3
+    assert task.done()
+    # the value is retained
+    assert task.get() == 3
+
+
+def test_interleaved_sleeps():
+    # each task sleeps for a shorter duration than the task spawned before
+    # it, such that tasks resume in the reverse order of their calls
+    order = []
+
+    def sleeper(idx, nsteps):
+        for step in range(nsteps):
+            evtlet.sleep(0.005 * (nsteps - idx))
+            order.append((step, idx))
+        return idx
+
+    nsteps = 4
+    tasks = [evtlet.spawn(sleeper, idx, nsteps) for idx in range(nsteps)]
+    assert [task.get() for task in reversed(tasks)] == [3, 2, 1, 0]
+    assert len(order) == nsteps * nsteps
+    first = [idx for step, idx in order if step == 0]
+    assert first == [3, 2, 1, 0]
+    assert evtlet.pending() == 0
+
+
+def test_yield_interleaved():
+    order = []
+
+    def worker(name):
+        for step in range(3):
+            order.append((name, step))
+            evtlet.sleep()
+
+    tasks = [evtlet.spawn(worker, name) for name in "abc"]
+    evtlet.joinall(tasks)
+    assert order == [(name, step) for step in range(3) for name in "abc"]
+
+
+def test_nested_get():
+    def leaf(depth):
+        evtlet.sleep(0.001 * depth)
+        return depth
+
+    def inner(depth):
+        if depth == 0:
+            return [leaf(0)]
+        # wait on a task spawned from within a task
+        child = evtlet.spawn(inner, depth - 1)
+        sibling = evtlet.spawn(leaf, depth)
+        return [sibling.get()] + child.get()
+
+    tasks = [evtlet.spawn(inner, depth) for depth in (5, 3, 4)]
+    assert tasks[1].get() == [3, 2, 1, 0]
+    assert tasks[0].get() == [5, 4, 3, 2, 1, 0]
+    assert tasks[2].get() == [4, 3, 2, 1, 0]
+
+
+def test_exception():
+    def fails(msg):
+        evtlet.sleep(0.001)
+        raise ValueError(msg)
+
+    task = evtlet.spawn(fails, "in task")
+    with pytest.raises(ValueError, match="in task") as info:
+        task.get()
+    # the traceback includes the task's frames
+    frames = [frame.name for frame in traceback.extract_tb(info.value.__traceback__)]
+    assert "fails" in frames
+    # raised again for each call
+    with pytest.raises(ValueError):
+        task.get()
+    # joinall will not raise
+    evtlet.joinall([task])
+
+
+def test_exception_nested():
+    def fails():
+        evtlet.sleep(0.001)
+        raise KeyError("inner")
+
+    def catches():
+        child = evtlet.spawn(fails)
+        try:
+            child.get()
+        except KeyError as exc:
+            return "caught " + exc.args[0]
+        return "not caught"
+
+    def propagates():
+        return evtlet.spawn(fails).get()
+
+    caught = evtlet.spawn(catches)
+    propagated = evtlet.spawn(propagates)
+    assert caught.get() == "caught inner"
+    with pytest.raises(KeyError):
+        propagated.get()
+
+
+def test_many_tasks():
+    def sleeper(idx):
+        evtlet.sleep(0.001 * (idx % 5))
+        evtlet.sleep(0.001 * (4 - idx % 5))
+        return idx
+
+    tasks = [evtlet.spawn(sleeper, idx) for idx in range(1000)]
+    assert sum(task.get() for task in reversed(tasks)) == sum(range(1000))
+    assert evtlet.pending() == 0
+
+
+def test_stream_echo():
+    left, right = socket.socketpair()
+    client = evtlet.Stream(left.detach())
+    native = evtlet.echo(evtlet.Stream(right.detach()))
+
+    def roundtrip(data):
+        client.send(data)
+        received = b""
+        while len(received) < len(data):
+            chunk = client.recv(len(data) - len(received))
+            assert chunk
+            received += chunk
+        return received
+
+    task = evtlet.spawn(roundtrip, b"x" * 100000)
+    assert task.get() == b"x" * 100000
+    client.close()
+    assert native.get() == 100000
+
+
+def test_listener():
+    lsock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    lsock.bind(("127.0.0.1", 0))
+    lsock.listen(4)
+    port = lsock.getsockname()[1]
+    listener = evtlet.Listener(lsock.detach())
+
+    def serve():
+        stream = listener.accept()
+        data = stream.recv(5)
+        stream.send(data.upper())
+        stream.close()
+        return data
+
+    def connect():
+        sock = socket.create_connection(("127.0.0.1", port))
+        stream = evtlet.Stream(sock.detach())
+        stream.send(b"hello")
+        data = stream.recv(5)
+        stream.close()
+        return data
+
+    server = evtlet.spawn(serve)
+    client = evtlet.spawn(connect)
+    assert client.get() == b"HELLO"
+    assert server.get() == b"hello"
+    listener.close()
+
+
+def test_errors():
+    with pytest.raises(TypeError):
+        evtlet.Task()
+    with pytest.raises(OSError):
+        evtlet.Stream(-1)
+    with pytest.raises(TypeError):
+        evtlet.joinall([1])
+    with pytest.raises(TypeError):
+        evtlet.spawn()
@@ -1,6 +1,9 @@
 
+#include <thread>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include <evtlet/evt/evt_state.hpp>
 #include <evtlet/util/mask.hpp>
 
 DEFMASK_T(state_t, size_t, ST_NEVER = 0, ST_NOW = 1, ST_DONE = 2);
@@ -39,3 +42,49 @@ TEST_CASE("test DEFMASK_T(state_t, size_t, ...)") {
   REQUIRE(t6 != t5);
   REQUIRE(t6 == 1);
 }
+
+TEST_CASE("test atomic_mask<state_t>") {
+  atomic_mask<state_t> st;
+  REQUIRE(st.load() == state_t::ST_NEVER);
+
+  REQUIRE(st.fetch_or(state_t::ST_NOW) == state_t::ST_NEVER);
+  REQUIRE(st.test(state_t::ST_NOW));
+  REQUIRE(!st.test(state_t::ST_NOW | state_t::ST_DONE));
+  REQUIRE(st.test_any(state_t::ST_NOW | state_t::ST_DONE));
+
+  auto expected = state_t::ST_DONE;
+  REQUIRE(!st.compare_exchange_strong(expected, state_t::ST_NEVER));
+  REQUIRE(expected == state_t::ST_NOW);
+  REQUIRE(st.compare_exchange_strong(expected, state_t::ST_NOW | 2));
+  REQUIRE(st.load() == 3);
+
+  REQUIRE(st.fetch_and(state_t::ST_DONE) == 3);
+  REQUIRE(st.load() == state_t::ST_DONE);
+  REQUIRE(st.fetch_xor(state_t::ST_NOW | 2) == state_t::ST_DONE);
+  REQUIRE(st.exchange(state_t::ST_NEVER) == state_t::ST_NOW);
+}
+
+TEST_CASE("test atomic_mask wait and notify across threads") {
+  atomic_mask<state_t> st(state_t::ST_NOW);
+  std::thread worker([&st]() {
+    st.fetch_or(state_t::ST_DONE);
+    st.notify_all();
+  });
+  for (auto cur = st.load(); !(cur & state_t::ST_DONE); cur = st.load()) {
+    st.wait(cur);
+  }
+  worker.join();
+  REQUIRE(st.test(state_t::ST_NOW | state_t::ST_DONE));
+}
+
+TEST_CASE("test evt_state as a bitmask") {
+  using evtlet::evt_state;
+  REQUIRE((evt_state::STATE_PENDING | evt_state::STATE_DETACHED) ==
+          evt_state::STATE_PENDING_DETACHED);
+  REQUIRE(!(evt_state::STATE_PENDING_DETACHED & evt_state::STATE_DONE));
+  atomic_mask<evt_state> st;
+  st.fetch_or(evt_state::STATE_PENDING);
+  REQUIRE(!st.test(evt_state::STATE_PENDING_DETACHED));
+  st.fetch_or(evt_state::STATE_DETACHED);
+  REQUIRE(st.load() == evt_state::STATE_PENDING_DETACHED);
+}
@@ -0,0 +1,95 @@
+
+#include <chrono>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <evtlet/ev/ev_clock.hpp>
+#include <evtlet/util/clock.hpp>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("test evtlet::clock") {
+  SECTION("clock: coarse time outside of a cache scope") {
+    REQUIRE(!evtlet::clock::cached());
+    const auto precise = evtlet::clock::precise_now();
+    const auto now = evtlet::clock::now();
+    // the coarse clock may lag by one scheduler tick
+    REQUIRE(now <= evtlet::clock::precise_now());
+    REQUIRE(precise - now < 50ms);
+  }
+
+  SECTION("clock: cached time within a cache scope") {
+    evtlet::clock_cache_scope scope;
+    REQUIRE(evtlet::clock::cached());
+    const auto first = evtlet::clock::now();
+    while (evtlet::clock::precise_now() == first) {
+    }
+    REQUIRE(evtlet::clock::now() == first);
+
+    evtlet::clock::update();
+    REQUIRE(evtlet::clock::now() > first);
+
+    const auto later = evtlet::clock::now() + 1h;
+    evtlet::clock::set(later);
+    REQUIRE(evtlet::clock::now() == later);
+    // the cached time does not decrease
+    evtlet::clock::set(first);
+    REQUIRE(evtlet::clock::now() == later);
+
+    {
+      evtlet::clock_cache_scope nested;
+      REQUIRE(evtlet::clock::now() == later);
+    }
+    REQUIRE(evtlet::clock::cached());
+  }
+
+  SECTION("clock: a new outermost scope replaces the cached time") {
+    const auto later = evtlet::clock::precise_now() + 1h;
+    {
+      evtlet::clock_cache_scope scope;
+      evtlet::clock::set(later);
+      REQUIRE(evtlet::clock::now() == later);
+    }
+    REQUIRE(evtlet::clock::now() < later);
+    evtlet::clock_cache_scope scope;
+    REQUIRE(evtlet::clock::now() < later);
+  }
+}
+
+struct timer_probe {
+  ev_timer timer;
+  std::vector<evtlet::clock::time_point> times;
+  bool cached;
+};
+
+static void probe_cb(EV_P_ ev_timer *w, int) {
+  auto *probe = static_cast<timer_probe *>(w->data);
+  probe->cached = evtlet::clock::cached();
+  probe->times.push_back(evtlet::clock::now());
+  probe->times.push_back(evtlet::clock::now());
+}
+
+TEST_CASE("test ev_clock") {
+  struct ev_loop *loop = ev_loop_new(EVFLAG_AUTO);
+  REQUIRE(loop);
+  const auto before = evtlet::clock::precise_now();
+  {
+    evtlet::ev_clock clk(loop);
+    timer_probe probe{{}, {}, false};
+    ev_timer_init(&probe.timer, probe_cb, 0.005, 0.);
+    probe.timer.data = &probe;
+    // the check watcher will run before a watcher of higher priority than
+    // the default
+    ev_set_priority(&probe.timer, EV_MAXPRI - 1);
+    ev_timer_start(loop, &probe.timer);
+    // the ev_clock watcher alone will not keep the loop running
+    ev_run(loop, 0);
+    REQUIRE(probe.cached);
+    REQUIRE(probe.times.size() == 2);
+    REQUIRE(probe.times[0] == probe.times[1]);
+    REQUIRE(probe.times[0] >= before + 5ms);
+  }
+  REQUIRE(!evtlet::clock::cached());
+  ev_loop_destroy(loop);
+}
@@ -0,0 +1,221 @@
+
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/io/conn_pool.hpp>
+#include <evtlet/io/fd_stream.hpp>
+#include <evtlet/util/scope_source.hpp>
+
+/// newline-delimited responses onto an fd_stream
+class line_conn {
+private:
+  evtlet::fd_stream m_stream;
+  std::string m_buf;
+
+public:
+  explicit line_conn(int fd) : m_stream(fd), m_buf() {}
+
+  size_t writev(struct iovec *iov, int iovcnt) {
+    return m_stream.writev(iov, iovcnt);
+  }
+
+  std::string read_response() {
+    size_t pos;
+    while ((pos = m_buf.find('\n')) == std::string::npos) {
+      char chunk[512];
+      const size_t nn = m_stream.read_some(chunk, sizeof(chunk));
+      if (nn == 0) {
+        throw std::runtime_error("connection closed");
+      }
+      m_buf.append(chunk, nn);
+    }
+    std::string line = m_buf.substr(0, pos);
+    m_buf.erase(0, pos + 1);
+    return line;
+  }
+};
+
+/// shared state for a `script_conn`
+struct script_state {
+  size_t nwrite;
+  size_t nread;
+  bool release_read;
+};
+
+/// connection failing every write after the first, while the reader waits
+/// for the first response
+class script_conn {
+private:
+  script_state *m_state;
+
+public:
+  explicit script_conn(script_state *state) : m_state(state) {}
+
+  size_t writev(struct iovec *iov, int iovcnt) {
+    if (++m_state->nwrite > 1) {
+      throw std::runtime_error("write failed");
+    }
+    size_t nn = 0;
+    for (int ii = 0; ii < iovcnt; ++ii) {
+      nn += iov[ii].iov_len;
+    }
+    return nn;
+  }
+
+  std::string read_response() {
+    while (!m_state->release_read) {
+      boost::this_fiber::yield();
+    }
+    ++m_state->nread;
+    return "late";
+  }
+};
+
+/// loopback stand-in for a backend server, replying to each line in order
+static void echo_server(int fd, size_t max_requests) {
+  std::string buf;
+  size_t nreq = 0;
+  char chunk[512];
+  while (nreq < max_requests) {
+    const ssize_t nn = ::read(fd, chunk, sizeof(chunk));
+    if (nn <= 0) {
+      break;
+    }
+    buf.append(chunk, static_cast<size_t>(nn));
+    std::string out;
+    size_t pos;
+    while ((pos = buf.find('\n')) != std::string::npos) {
+      out += "re:" + buf.substr(0, pos + 1);
+      buf.erase(0, pos + 1);
+      ++nreq;
+    }
+    if (!out.empty() && ::write(fd, out.data(), out.size()) < 0) {
+      break;
+    }
+  }
+  ::close(fd);
+}
+
+TEST_CASE("test conn_pool") {
+  SECTION("conn_pool: concurrent calls over two connections") {
+    constexpr size_t nfibers = 32, ncalls = 20, nconns = 2;
+    std::vector<std::thread> servers;
+    std::vector<line_conn> conns;
+    for (size_t ii = 0; ii < nconns; ++ii) {
+      int sv[2];
+      REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+      servers.emplace_back(echo_server, sv[1], nfibers * ncalls);
+      conns.emplace_back(sv[0]);
+    }
+
+    size_t nok = 0;
+    {
+      evtlet::conn_pool<line_conn, std::string> pool(std::move(conns));
+      REQUIRE(pool.size() == nconns);
+      std::vector<boost::fibers::fiber> clients;
+      for (size_t ff = 0; ff < nfibers; ++ff) {
+        clients.emplace_back([&pool, &nok, ff]() {
+          for (size_t cc = 0; cc < ncalls; ++cc) {
+            const auto req =
+                std::to_string(ff) + "." + std::to_string(cc) + "\n";
+            const auto rsp = pool.call(req);
+            if (rsp == "re:" + req.substr(0, req.size() - 1)) {
+              ++nok;
+            }
+          }
+        });
+      }
+      for (auto &cl : clients) {
+        cl.join();
+      }
+    }
+    REQUIRE(nok == nfibers * ncalls);
+    for (auto &srv : servers) {
+      srv.join();
+    }
+  }
+
+  SECTION("conn_pool: pending calls fail when the connection is closed") {
+    // writes after the server has closed would otherwise raise SIGPIPE.
+    // The previous disposition is restored for later tests
+    struct sigaction ign {}, prev {};
+    ign.sa_handler = SIG_IGN;
+    ::sigemptyset(&ign.sa_mask);
+    REQUIRE(::sigaction(SIGPIPE, &ign, &prev) == 0);
+    SCOPE_EXIT restore{[&prev]() { ::sigaction(SIGPIPE, &prev, nullptr); }};
+    int sv[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    // the server will close without replying
+    std::thread server(echo_server, sv[1], 0);
+    std::vector<line_conn> conns;
+    conns.emplace_back(sv[0]);
+
+    size_t nok = 0, nfail = 0;
+    {
+      evtlet::conn_pool<line_conn, std::string> pool(std::move(conns));
+      std::vector<boost::fibers::fiber> clients;
+      for (size_t ff = 0; ff < 4; ++ff) {
+        clients.emplace_back([&pool, &nok, &nfail]() {
+          try {
+            pool.call("req\n");
+            ++nok;
+          } catch (const std::exception &) {
+            ++nfail;
+          }
+        });
+      }
+      for (auto &cl : clients) {
+        cl.join();
+      }
+    }
+    server.join();
+    REQUIRE(nok == 0);
+    REQUIRE(nfail == 4);
+  }
+
+  SECTION("conn_pool: a response read after the writer has failed") {
+    script_state state{0, 0, false};
+    std::vector<script_conn> conns;
+    conns.emplace_back(&state);
+
+    size_t nfail = 0;
+    {
+      evtlet::conn_pool<script_conn, std::string> pool(std::move(conns), 1);
+      auto client = [&pool, &nfail](const char *req) {
+        try {
+          pool.call(req);
+        } catch (const std::exception &) {
+          ++nfail;
+        }
+      };
+      boost::fibers::fiber c1(client, "a\n");
+      while (state.nwrite < 1) {
+        boost::this_fiber::yield();
+      }
+      // the second write fails both requests, while the reader is still
+      // waiting for the first response
+      boost::fibers::fiber c2(client, "b\n");
+      while (nfail < 2) {
+        boost::this_fiber::yield();
+      }
+      state.release_read = true;
+      while (state.nread < 1) {
+        boost::this_fiber::yield();
+      }
+      c1.join();
+      c2.join();
+    }
+    REQUIRE(nfail == 2);
+    REQUIRE(state.nwrite == 2);
+  }
+}
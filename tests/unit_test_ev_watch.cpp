@@ -0,0 +1,217 @@
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/future/promise.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/ev/ev_loop_fiber.hpp>
+#include <evtlet/ev/ev_watch.hpp>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("test ev_loop_fiber") {
+  struct ev_loop *loop = ev_loop_new(EVFLAG_AUTO);
+  REQUIRE(loop);
+  {
+    evtlet::ev_loop_fiber lf(loop, 1ms);
+    size_t nyield = 0;
+    boost::fibers::fiber ff([&nyield]() {
+      for (; nyield < 100; ++nyield) {
+        boost::this_fiber::yield();
+      }
+      // woken by the fiber scheduler, while the loop fiber may be blocked
+      boost::this_fiber::sleep_for(5ms);
+    });
+    ff.join();
+    REQUIRE(nyield == 100);
+    REQUIRE(ev_iteration(loop) > 0);
+  }
+  ev_loop_destroy(loop);
+}
+
+struct timer_flag {
+  ev_timer timer;
+  boost::fibers::mutex mtx;
+  boost::fibers::condition_variable cnd;
+  bool fired;
+};
+
+static void on_timer_flag(EV_P_ ev_timer *w, int) {
+  auto *tf = static_cast<timer_flag *>(w->data);
+  std::unique_lock<boost::fibers::mutex> lck(tf->mtx);
+  tf->fired = true;
+  tf->cnd.notify_all();
+}
+
+TEST_CASE("test ev_loop_fiber with ev_loop_algo") {
+  struct ev_loop *loop = ev_loop_new(EVFLAG_AUTO);
+  REQUIRE(loop);
+  std::chrono::steady_clock::duration slept{};
+  std::chrono::steady_clock::duration remote{};
+  bool fired = false;
+  std::thread thr([&]() {
+    boost::fibers::use_scheduling_algorithm<evtlet::ev_loop_algo>(loop);
+    // without the algorithm, only loop events would wake the thread
+    evtlet::ev_loop_fiber lf(loop, evtlet::ev_loop_fiber::duration::max());
+
+    // woken for the fiber's deadline
+    auto start = std::chrono::steady_clock::now();
+    boost::this_fiber::sleep_for(5ms);
+    slept = std::chrono::steady_clock::now() - start;
+
+    // woken for a fiber made ready from another thread
+    boost::fibers::promise<int> prom;
+    auto fut = prom.get_future();
+    start = std::chrono::steady_clock::now();
+    std::thread setter([&prom]() {
+      std::this_thread::sleep_for(5ms);
+      prom.set_value(1);
+    });
+    REQUIRE(fut.get() == 1);
+    remote = std::chrono::steady_clock::now() - start;
+    setter.join();
+
+    // watcher callbacks run on the loop fiber
+    timer_flag tf;
+    tf.fired = false;
+    ev_timer_init(&tf.timer, on_timer_flag, 0.005, 0.);
+    tf.timer.data = &tf;
+    ev_timer_start(loop, &tf.timer);
+    {
+      std::unique_lock<boost::fibers::mutex> lck(tf.mtx);
+      while (!tf.fired) {
+        tf.cnd.wait(lck);
+      }
+    }
+    fired = tf.fired;
+    // stopped by the destructor, while suspended
+  });
+  thr.join();
+  ev_loop_destroy(loop);
+  REQUIRE(slept >= 5ms);
+  REQUIRE(slept < 1s);
+  REQUIRE(remote >= 5ms);
+  REQUIRE(remote < 1s);
+  REQUIRE(fired);
+}
+
+TEST_CASE("test ev_signal_evt") {
+  struct ev_loop *loop = ev_default_loop(0);
+  evtlet::ev_loop_fiber lf(loop);
+  evtlet::ev_signal_evt sig(loop, SIGUSR1);
+  REQUIRE(sig.active());
+  REQUIRE(!sig.done());
+
+  // the watcher was started on construction, before the event is waited
+  ::raise(SIGUSR1);
+  REQUIRE(sig.get() == SIGUSR1);
+  REQUIRE(sig.done());
+  REQUIRE(!sig.active());
+}
+
+TEST_CASE("test ev_watch_evt destroyed before the watcher is invoked") {
+  struct ev_loop *loop = ev_default_loop(0);
+  evtlet::ev_loop_fiber lf(loop);
+  {
+    evtlet::ev_signal_evt sig(loop, SIGUSR2);
+    sig.dispatch_detached();
+    boost::this_fiber::yield();
+    REQUIRE(sig.active());
+    REQUIRE(!sig.done());
+  }
+
+  // the signal is delivered only to the event watching it now
+  evtlet::ev_signal_evt sig(loop, SIGUSR2);
+  ::raise(SIGUSR2);
+  REQUIRE(sig.get() == SIGUSR2);
+  REQUIRE(sig.get_state() == evtlet::evt_state::STATE_DONE);
+}
+
+TEST_CASE("test ev_child_evt") {
+  struct ev_loop *loop = ev_default_loop(0);
+  evtlet::ev_loop_fiber lf(loop);
+
+  const pid_t pid = ::fork();
+  REQUIRE(pid >= 0);
+  if (pid == 0) {
+    ::_exit(3);
+  }
+  evtlet::ev_child_evt child(loop, pid);
+  REQUIRE(child.pid() == pid);
+
+  // other fibers will continue while the child is waited
+  size_t nyield = 0;
+  boost::fibers::fiber ff([&child, &nyield]() {
+    while (!child.done()) {
+      ++nyield;
+      boost::this_fiber::yield();
+    }
+  });
+  const int status = child.get();
+  ff.join();
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 3);
+  REQUIRE(nyield > 0);
+}
+
+TEST_CASE("test ev_stat_stream") {
+  char path[] = "/tmp/evtlet_stat_XXXXXX";
+  const int fd = ::mkstemp(path);
+  REQUIRE(fd >= 0);
+  ::close(fd);
+
+  struct ev_loop *loop = ev_loop_new(EVFLAG_AUTO);
+  REQUIRE(loop);
+  {
+    evtlet::ev_loop_fiber lf(loop);
+    evtlet::ev_stat_stream stream(loop, path, 0.01);
+    REQUIRE(stream.path() == path);
+    REQUIRE(!stream.try_next().has_value());
+
+    boost::fibers::fiber writer([&path]() {
+      boost::this_fiber::sleep_for(20ms);
+      const int wfd = ::open(path, O_WRONLY | O_APPEND);
+      static_cast<void>(::write(wfd, "changed\n", 8));
+      ::close(wfd);
+    });
+    auto change = stream.next();
+    REQUIRE(change.has_value());
+    REQUIRE(change->prev.st_size == 0);
+    REQUIRE(change->attr.st_size == 8);
+    writer.join();
+
+    boost::fibers::fiber remover([&path]() {
+      boost::this_fiber::sleep_for(20ms);
+      ::unlink(path);
+    });
+    change = stream.next();
+    REQUIRE(change.has_value());
+    REQUIRE(change->attr.st_nlink == 0);
+    remover.join();
+
+    // closing the stream will wake a waiting fiber
+    bool closed = false;
+    boost::fibers::fiber waiter([&stream, &closed]() {
+      closed = !stream.next().has_value();
+    });
+    boost::this_fiber::yield();
+    stream.close();
+    waiter.join();
+    REQUIRE(closed);
+  }
+  ev_loop_destroy(loop);
+  ::unlink(path);
+}
@@ -0,0 +1,105 @@
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_cache.hpp>
+
+using cache_t = evtlet::evt_cache<std::string, int>;
+
+TEST_CASE("test evt_cache") {
+  SECTION("evt_cache: concurrent callers share one call") {
+    cache_t cache(std::chrono::hours(1));
+    size_t ncalls = 0;
+    std::vector<int> results;
+    std::vector<boost::fibers::fiber> callers;
+    for (size_t ii = 0; ii < 16; ++ii) {
+      callers.emplace_back([&cache, &ncalls, &results]() {
+        auto evt = cache.get_or_spawn("hot", [&ncalls]() {
+          ++ncalls;
+          for (size_t yy = 0; yy < 4; ++yy) {
+            boost::this_fiber::yield();
+          }
+          return 42;
+        });
+        results.push_back(evt->get());
+      });
+    }
+    for (auto &cc : callers) {
+      cc.join();
+    }
+    REQUIRE(ncalls == 1);
+    REQUIRE(results == std::vector<int>(16, 42));
+
+    // the completed event is retained within the TTL
+    auto evt = cache.get_or_spawn("hot", []() { return -1; });
+    REQUIRE(evt->get() == 42);
+    REQUIRE(cache.size() == 1);
+  }
+
+  SECTION("evt_cache: completed events expire after the TTL") {
+    cache_t cache(std::chrono::nanoseconds(0));
+    REQUIRE(cache.get_or_spawn("k", []() { return 1; })->get() == 1);
+    REQUIRE(cache.find("k") == nullptr);
+    REQUIRE(cache.get_or_spawn("k", []() { return 2; })->get() == 2);
+  }
+
+  SECTION("evt_cache: completed events are bounded, oldest first") {
+    cache_t cache(std::chrono::hours(1), 2);
+    for (int ii = 0; ii < 3; ++ii) {
+      auto evt = cache.get_or_spawn(std::to_string(ii), [ii]() { return ii; });
+      REQUIRE(evt->get() == ii);
+    }
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.find("0") == nullptr);
+    REQUIRE(cache.find("2") != nullptr);
+  }
+
+  SECTION("evt_cache: erase while pending") {
+    cache_t cache(std::chrono::hours(1));
+    auto evt = cache.get_or_spawn("k", []() { return 1; });
+    cache.erase("k");
+    REQUIRE(cache.size() == 0);
+    REQUIRE(evt->get() == 1);
+    REQUIRE(cache.size() == 0);
+  }
+
+  SECTION("evt_cache: an exception is rethrown and not retained") {
+    cache_t cache(std::chrono::hours(1));
+    auto evt = cache.get_or_spawn(
+        "k", []() -> int { throw std::runtime_error("failed"); });
+    REQUIRE_THROWS_AS(evt->get(), std::runtime_error);
+    REQUIRE(evt->done());
+    REQUIRE(evt->has_error());
+    REQUIRE(!evt->has_value());
+    // rethrown for each caller
+    REQUIRE_THROWS_AS(evt->get(), std::runtime_error);
+    REQUIRE(cache.find("k") == nullptr);
+    REQUIRE(cache.get_or_spawn("k", []() { return 2; })->get() == 2);
+  }
+
+  SECTION("evt_cache: an evicted event outlives its fiber") {
+    // each entry is evicted as it is marked done, while the caller holds
+    // no reference to the event
+    cache_t cache(std::chrono::hours(1), 0);
+    size_t ncalls = 0;
+    for (int ii = 0; ii < 16; ++ii) {
+      cache.get_or_spawn(std::to_string(ii), [&ncalls, ii]() {
+        boost::this_fiber::yield();
+        ++ncalls;
+        return ii;
+      });
+    }
+    REQUIRE(cache.size() == 16);
+    while (cache.size() > 0) {
+      boost::this_fiber::yield();
+    }
+    REQUIRE(ncalls == 16);
+  }
+}
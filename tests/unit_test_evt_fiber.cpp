@@ -1,8 +1,12 @@
 
+#include <atomic>
 #include <memory>
+#include <stdexcept>
+#include <thread>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <evtlet/evt/evt_call.hpp>
 #include <evtlet/evt/evt_cc.hpp>
 #include <evtlet/evt/evt_fiber.hpp>
 
@@ -145,3 +149,59 @@ TEST_CASE("test immediate dispatch") {
     REQUIRE(vv == vfiber.get());
   }
 }
+
+TEST_CASE("test dispatch_detached") {
+  evtlet::evt_call<int> ev([]() { return 3; });
+  ev.dispatch_detached();
+  // detached when the fiber is created, before the fiber has run
+  REQUIRE(ev.get_state() == evtlet::evt_state::STATE_PENDING_DETACHED);
+  REQUIRE(ev.get_detached_state().value());
+  // a second call will not create or detach another fiber
+  ev.dispatch_detached();
+  REQUIRE(ev.get() == 3);
+  REQUIRE(ev.get_state() == evtlet::evt_state::STATE_DONE);
+}
+
+TEST_CASE("test evt_fiber with an exception") {
+  evtlet::evt_call<int> ev([]() -> int { throw std::logic_error("failed"); });
+  REQUIRE_THROWS_AS(ev.get(), std::logic_error);
+  REQUIRE(ev.done());
+  REQUIRE(ev.has_error());
+  REQUIRE(!ev.has_value());
+  // the exception is retained, and rethrown for each call
+  ev.wait();
+  REQUIRE_THROWS_AS(ev.get(), std::logic_error);
+}
+
+TEST_CASE("test evt_fiber destroyed by a waiter on another thread") {
+  // the waiter will destroy each event as soon as done() is observed,
+  // while the event's fiber may still be running on the main thread
+  constexpr int nevents = 100000;
+  std::atomic<evtlet::evt_call<int> *> slot{nullptr};
+  std::atomic<int> nbad{0};
+  std::thread waiter([&slot, &nbad]() {
+    for (int ii = 0; ii < nevents; ++ii) {
+      evtlet::evt_call<int> *ev = nullptr;
+      while (!(ev = slot.exchange(nullptr))) {
+        std::this_thread::yield();
+      }
+      while (!ev->done()) {
+      }
+      if (ev->get() != ii) {
+        nbad.fetch_add(1);
+      }
+      delete ev;
+    }
+  });
+  for (int ii = 0; ii < nevents; ++ii) {
+    auto *ev = new evtlet::evt_call<int>([ii]() { return ii; });
+    evtlet::evt_call<int> *prev = nullptr;
+    while (!slot.compare_exchange_weak(prev, ev)) {
+      prev = nullptr;
+      std::this_thread::yield();
+    }
+    ev->dispatch();
+  }
+  waiter.join();
+  REQUIRE(nbad.load() == 0);
+}
@@ -0,0 +1,118 @@
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <evtlet/evt/evt_graph.hpp>
+#include <evtlet/rt/worker_pool.hpp>
+
+using graph_t = evtlet::evt_graph<int>;
+
+TEST_CASE("test evt_graph") {
+  SECTION("evt_graph: diamond, run repeatedly") {
+    graph_t graph;
+    int base = 1;
+    std::vector<size_t> ncalls(4, 0);
+    auto aa = graph.add_node([&](graph_t::inputs_t) {
+      ++ncalls[0];
+      return base;
+    });
+    auto bb = graph.add_node(
+        [&](graph_t::inputs_t in) {
+          ++ncalls[1];
+          return *in[0] + 1;
+        },
+        {aa});
+    auto cc = graph.add_node(
+        [&](graph_t::inputs_t in) {
+          ++ncalls[2];
+          return *in[0] * 10;
+        },
+        {aa});
+    auto dd = graph.add_node(
+        [&](graph_t::inputs_t in) {
+          ++ncalls[3];
+          REQUIRE(in.size() == 2);
+          return *in[0] - *in[1];
+        },
+        {cc, bb});
+    REQUIRE(graph.size() == 4);
+
+    graph.run();
+    REQUIRE(graph.value(dd) == 8);
+    base = 3;
+    graph.run();
+    REQUIRE(graph.value(bb) == 4);
+    REQUIRE(graph.value(dd) == 26);
+    REQUIRE(ncalls == std::vector<size_t>(4, 2));
+  }
+
+  SECTION("evt_graph: stacks are reused across runs") {
+    graph_t graph;
+    std::vector<graph_t::node_id> leaves;
+    for (int ii = 0; ii < 16; ++ii) {
+      leaves.push_back(graph.add_node([ii](graph_t::inputs_t) { return ii; }));
+    }
+    auto sum = graph.add_node(
+        [](graph_t::inputs_t in) {
+          int acc = 0;
+          for (const int *vv : in) {
+            acc += *vv;
+          }
+          return acc;
+        },
+        leaves);
+    for (int rr = 0; rr < 10; ++rr) {
+      graph.run();
+      REQUIRE(graph.value(sum) == 120);
+    }
+    REQUIRE(graph.stacks().allocated() <= graph.size());
+  }
+
+  SECTION("evt_graph: dependencies must be declared first") {
+    graph_t graph;
+    REQUIRE_THROWS_AS(graph.add_node([](graph_t::inputs_t) { return 0; }, {0}),
+                      std::out_of_range);
+    REQUIRE(graph.size() == 0);
+    graph.run();
+  }
+}
+
+TEST_CASE("test evt_graph with a worker_pool") {
+  evtlet::worker_pool pool(3);
+  graph_t graph;
+  std::atomic<size_t> ncalls{0};
+  // a chain of layers, each with several independent nodes
+  std::vector<graph_t::node_id> layer;
+  for (int ii = 0; ii < 8; ++ii) {
+    layer.push_back(graph.add_node([ii, &ncalls](graph_t::inputs_t) {
+      ncalls.fetch_add(1);
+      return ii;
+    }));
+  }
+  for (int depth = 0; depth < 4; ++depth) {
+    std::vector<graph_t::node_id> next;
+    for (size_t ii = 0; ii < layer.size(); ++ii) {
+      next.push_back(graph.add_node(
+          [&ncalls](graph_t::inputs_t in) {
+            ncalls.fetch_add(1);
+            boost::this_fiber::yield();
+            return *in[0] + *in[1];
+          },
+          {layer[ii], layer[(ii + 1) % layer.size()]}));
+    }
+    layer = next;
+  }
+  for (int rr = 0; rr < 20; ++rr) {
+    graph.run();
+  }
+  int total = 0;
+  for (auto id : layer) {
+    total += graph.value(id);
+  }
+  // each layer doubles the sum of the previous layer
+  REQUIRE(total == 28 * 16);
+  REQUIRE(ncalls.load() == 20 * 40);
+}
@@ -0,0 +1,93 @@
+
+#include <atomic>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <evtlet/evt/evt_parallel.hpp>
+#include <evtlet/rt/worker_pool.hpp>
+
+TEST_CASE("test parallel_for") {
+  SECTION("parallel_for: index range") {
+    std::vector<int> vals(1000, 0);
+    evtlet::parallel_for(0, 1000, 16, [&vals](int ii) {
+      vals[static_cast<size_t>(ii)] = ii;
+    });
+    for (size_t ii = 0; ii < vals.size(); ++ii) {
+      REQUIRE(vals[ii] == static_cast<int>(ii));
+    }
+  }
+
+  SECTION("parallel_for: empty range") {
+    size_t ncalls = 0;
+    evtlet::parallel_for(5, 5, 1, [&ncalls](int) { ++ncalls; });
+    evtlet::parallel_for(5, 2, 1, [&ncalls](int) { ++ncalls; });
+    REQUIRE(ncalls == 0);
+  }
+
+  SECTION("parallel_for: random-access range, zero grain") {
+    std::vector<size_t> vals(100);
+    std::iota(vals.begin(), vals.end(), 0);
+    evtlet::parallel_for(vals, 0, [](size_t &vv) { vv *= 2; });
+    for (size_t ii = 0; ii < vals.size(); ++ii) {
+      REQUIRE(vals[ii] == 2 * ii);
+    }
+  }
+}
+
+TEST_CASE("test map_reduce") {
+  SECTION("map_reduce: sum of squares") {
+    auto rslt = evtlet::map_reduce(
+        static_cast<size_t>(0), static_cast<size_t>(1000), 32,
+        static_cast<size_t>(0), [](size_t ii) { return ii * ii; },
+        [](size_t lv, size_t rv) { return lv + rv; });
+    REQUIRE(rslt == 332833500);
+  }
+
+  SECTION("map_reduce: order is preserved for a non-commutative reduce") {
+    std::string chars = "abcdefghijklmnopqrstuvwxyz";
+    auto rslt = evtlet::map_reduce(
+        chars, 3, std::string(), [](char cc) { return std::string(1, cc); },
+        [](std::string lv, std::string rv) { return lv + rv; });
+    REQUIRE(rslt == chars);
+  }
+
+  SECTION("map_reduce: grain larger than the range") {
+    auto rslt = evtlet::map_reduce(
+        1, 11, 100, 0, [](int ii) { return ii; },
+        [](int lv, int rv) { return lv + rv; });
+    REQUIRE(rslt == 55);
+  }
+}
+
+TEST_CASE("test map_reduce with worker_pool") {
+  evtlet::worker_pool pool(4);
+  REQUIRE(pool.size() == 4);
+
+  std::atomic<size_t> ncalls{0};
+  auto rslt = evtlet::map_reduce(
+      static_cast<size_t>(0), static_cast<size_t>(4096), 64,
+      static_cast<size_t>(0),
+      [&ncalls](size_t ii) {
+        ncalls.fetch_add(1, std::memory_order_relaxed);
+        return ii;
+      },
+      [](size_t lv, size_t rv) { return lv + rv; });
+  REQUIRE(ncalls.load() == 4096);
+  REQUIRE(rslt == 4096 * 4095 / 2);
+}
+
+TEST_CASE("test map_reduce with worker_pool and grain 1") {
+  // each sub-event is destroyed by its parent fiber as soon as get()
+  // returns, possibly on another thread than the sub-event's own fiber
+  evtlet::worker_pool pool(4);
+  for (size_t nn = 0; nn < 100; ++nn) {
+    auto rslt = evtlet::map_reduce(
+        static_cast<size_t>(0), static_cast<size_t>(4096), 1,
+        static_cast<size_t>(0), [](size_t ii) { return ii; },
+        [](size_t lv, size_t rv) { return lv + rv; });
+    REQUIRE(rslt == 4096 * 4095 / 2);
+  }
+}
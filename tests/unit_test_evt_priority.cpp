@@ -0,0 +1,130 @@
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_priority.hpp>
+
+using evtlet::evt_priority;
+
+class record_evt : public evtlet::evt_prio<int> {
+public:
+  record_evt(std::vector<std::string> &order, std::string name,
+             evt_priority prio, evtlet::evt_admission *gate = nullptr,
+             size_t nyield = 0)
+      : evtlet::evt_prio<int>(prio, gate), m_order(order), m_name(name),
+        m_nyield(nyield) {}
+
+  static size_t inside, max_inside;
+
+protected:
+  std::vector<std::string> &m_order;
+  const std::string m_name;
+  const size_t m_nyield;
+
+  virtual int func() {
+    ++inside;
+    max_inside = std::max(max_inside, inside);
+    m_order.push_back(m_name);
+    for (size_t ii = 0; ii < m_nyield; ++ii) {
+      boost::this_fiber::yield();
+    }
+    --inside;
+    return static_cast<int>(m_order.size());
+  }
+};
+
+size_t record_evt::inside = 0;
+size_t record_evt::max_inside = 0;
+
+TEST_CASE("test priority_scheduler") {
+  boost::fibers::use_scheduling_algorithm<evtlet::priority_scheduler>();
+
+  SECTION("priority_scheduler: ready fibers run by priority") {
+    std::vector<std::string> order;
+    record_evt bulk(order, "bulk", evt_priority::PRIO_BULK);
+    record_evt normal(order, "normal", evt_priority::PRIO_NORMAL);
+    record_evt high(order, "high", evt_priority::PRIO_HIGH);
+    bulk.dispatch_detached();
+    normal.dispatch_detached();
+    high.dispatch_detached();
+    // the main fiber is requeued at PRIO_NORMAL, after `normal`
+    boost::this_fiber::yield();
+    REQUIRE(order == std::vector<std::string>{"high", "normal"});
+    bulk.get();
+    REQUIRE(order == std::vector<std::string>{"high", "normal", "bulk"});
+  }
+
+  SECTION("evt_admission: in-flight limit, queued by priority") {
+    std::vector<std::string> order;
+    evtlet::evt_admission gate(2);
+    record_evt::inside = record_evt::max_inside = 0;
+    record_evt b1(order, "b1", evt_priority::PRIO_BULK, &gate, 3);
+    record_evt b2(order, "b2", evt_priority::PRIO_BULK, &gate, 3);
+    record_evt b3(order, "b3", evt_priority::PRIO_BULK, &gate, 3);
+    record_evt c1(order, "c1", evt_priority::PRIO_CRITICAL, &gate, 3);
+    b1.dispatch_detached();
+    b2.dispatch_detached();
+    REQUIRE(gate.inflight() == 2);
+    b3.dispatch_detached();
+    c1.dispatch_detached();
+    REQUIRE(gate.queued() == 2);
+    REQUIRE(!c1.fiber_pending());
+
+    b3.get();
+    c1.get();
+    b1.get();
+    b2.get();
+    REQUIRE(record_evt::max_inside == 2);
+    REQUIRE(order.size() == 4);
+    // c1 was admitted before b3, though submitted later
+    REQUIRE(std::find(order.begin(), order.end(), "c1") <
+            std::find(order.begin(), order.end(), "b3"));
+    REQUIRE(gate.queued() == 0);
+    boost::this_fiber::yield();
+    REQUIRE(gate.inflight() == 0);
+  }
+
+  SECTION("evt_admission: an event destroyed while queued is withdrawn") {
+    std::vector<std::string> order;
+    evtlet::evt_admission gate(1);
+    record_evt::inside = record_evt::max_inside = 0;
+    record_evt b1(order, "b1", evt_priority::PRIO_BULK, &gate, 3);
+    b1.dispatch_detached();
+    auto q1 = std::make_unique<record_evt>(order, "q1",
+                                           evt_priority::PRIO_BULK, &gate);
+    q1->dispatch_detached();
+    REQUIRE(gate.queued() == 1);
+    q1.reset();
+    REQUIRE(gate.queued() == 0);
+
+    b1.get();
+    boost::this_fiber::yield();
+    REQUIRE(gate.inflight() == 0);
+    REQUIRE(order == std::vector<std::string>{"b1"});
+  }
+
+  SECTION("evt_admission: an event admitted then destroyed is cancelled") {
+    std::vector<std::string> order;
+    evtlet::evt_admission gate(1);
+    record_evt b1(order, "b1", evt_priority::PRIO_BULK, &gate);
+    b1.dispatch_detached();
+    auto q1 = std::make_unique<record_evt>(order, "q1",
+                                           evt_priority::PRIO_BULK, &gate, 3);
+    q1->dispatch_detached();
+    REQUIRE(gate.queued() == 1);
+    // b1's fiber will launch q1 from the queue, on completion
+    b1.get();
+    REQUIRE(gate.queued() == 0);
+    REQUIRE(q1->fiber_pending());
+    // the destructor waits for q1's fiber, which will not call func()
+    q1.reset();
+    REQUIRE(order == std::vector<std::string>{"b1"});
+    REQUIRE(gate.inflight() == 0);
+  }
+}
@@ -0,0 +1,96 @@
+
+#include <atomic>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/fiber.hpp>
+
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/evt/evt_parallel.hpp>
+#include <evtlet/rt/numa_alloc.hpp>
+#include <evtlet/rt/worker_pool.hpp>
+#include <evtlet/sync/latch.hpp>
+#include <evtlet/util/numa.hpp>
+
+class numa_int
+    : public evtlet::evt_fiber<int, boost::fibers::mutex,
+                               boost::fibers::condition_variable,
+                               evtlet::numa_stack> {
+public:
+  explicit numa_int(int value) : m_value(value) {}
+
+protected:
+  const int m_value;
+  virtual int func() { return m_value; }
+};
+
+TEST_CASE("test parse_cpulist") {
+  REQUIRE(evtlet::parse_cpulist("0") == std::vector<int>{0});
+  REQUIRE(evtlet::parse_cpulist("0-3,8-9,12\n") ==
+          std::vector<int>{0, 1, 2, 3, 8, 9, 12});
+  REQUIRE(evtlet::parse_cpulist("").empty());
+  REQUIRE(evtlet::parse_cpulist("x,2,5-3,7-") == std::vector<int>{2});
+}
+
+TEST_CASE("test numa_topology") {
+  const auto nodes = evtlet::numa_topology();
+  REQUIRE(!nodes.empty());
+  for (const auto &node : nodes) {
+    REQUIRE(!node.cpus.empty());
+  }
+  const int cur = evtlet::numa_current_node(nodes);
+  bool found = false;
+  for (const auto &node : nodes) {
+    found = found || node.id == cur;
+  }
+  REQUIRE(found);
+}
+
+TEST_CASE("test numa allocation") {
+  const int node = evtlet::numa_topology().front().id;
+
+  SECTION("numa_resource: node-local arena") {
+    evtlet::numa_resource upstream(node);
+    std::pmr::monotonic_buffer_resource arena(&upstream);
+    std::pmr::vector<int> vals(&arena);
+    for (int ii = 0; ii < 10000; ++ii) {
+      vals.push_back(ii);
+    }
+    REQUIRE(vals[9999] == 9999);
+  }
+
+  SECTION("numa_stack: as stack allocator for evt_fiber") {
+    evtlet::numa_stack salloc(64 * 1024, node);
+    auto sctx = salloc.allocate();
+    REQUIRE(sctx.size >= 64 * 1024);
+    std::memset(static_cast<char *>(sctx.sp) - sctx.size, 0, sctx.size);
+    salloc.deallocate(sctx);
+
+    numa_int evt(7);
+    REQUIRE(evt.get() == 7);
+  }
+}
+
+TEST_CASE("test worker_pool with NUMA placement") {
+  evtlet::worker_pool pool(3, false, evtlet::placement::PLACE_NUMA);
+  REQUIRE(pool.size() == 3);
+
+  std::atomic<size_t> nposted{0};
+  evtlet::latch done(2);
+  for (size_t ii = 1; ii < pool.size(); ++ii) {
+    pool.post(ii, [&nposted, &done]() {
+      nposted.fetch_add(1);
+      done.count_down();
+    });
+  }
+  done.wait();
+  REQUIRE(nposted.load() == 2);
+
+  auto rslt = evtlet::map_reduce(
+      0, 1000, 8, 0, [](int ii) { return ii; },
+      [](int lv, int rv) { return lv + rv; });
+  REQUIRE(rslt == 999 * 1000 / 2);
+}
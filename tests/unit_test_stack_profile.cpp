@@ -0,0 +1,86 @@
+
+#ifndef EVTLET_STACK_PROFILE
+#define EVTLET_STACK_PROFILE 1
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_cc.hpp>
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/rt/stack_profile.hpp>
+
+// use about `depth` KiB of stack
+static int deep_call(size_t depth) {
+  volatile char frame[1024];
+  std::memset(const_cast<char *>(frame), static_cast<int>(depth), 1024);
+  return depth ? frame[depth % 1024] + deep_call(depth - 1) : frame[0];
+}
+
+class shallow_evt : public evtlet::evt_fiber<int> {
+protected:
+  virtual int func() { return 1; }
+};
+
+class deep_evt : public evtlet::evt_fiber<int> {
+protected:
+  virtual int func() { return deep_call(24); }
+};
+
+class deep_cc : public evtlet::evt_cc<int> {
+protected:
+  virtual int func() { return deep_call(24); }
+};
+
+static evtlet::stack_usage usage_of(const evtlet::evt<int> &evt) {
+  // the fiber's stack will be released once the dispatcher has run
+  boost::this_fiber::sleep_for(std::chrono::milliseconds(1));
+  return evtlet::stack_profile::instance().usage_of(evt.evt_tag());
+}
+
+TEST_CASE("test stack profiling") {
+  auto &profile = evtlet::stack_profile::instance();
+  profile.reset();
+
+  SECTION("profiled_stack: high-water marks by event type") {
+    for (size_t ii = 0; ii < 3; ++ii) {
+      shallow_evt shallow;
+      shallow.get();
+      deep_evt deep;
+      deep.get();
+    }
+    const auto shallow = usage_of(shallow_evt());
+    const auto deep = usage_of(deep_evt());
+    REQUIRE(shallow.count == 3);
+    REQUIRE(deep.count == 3);
+    REQUIRE(deep.max_used >= 24 * 1024);
+    REQUIRE(deep.max_used < deep.stack_size);
+    REQUIRE(shallow.max_used < deep.max_used);
+    REQUIRE(deep.buckets[evtlet::stack_usage::bucket_of(deep.max_used)] > 0);
+
+    std::ostringstream out;
+    profile.write(out);
+    REQUIRE(out.str().find("deep_evt") != std::string::npos);
+  }
+
+  SECTION("profiled_stack: evt_cc continuations") {
+    deep_cc evt;
+    REQUIRE(evt.get() != 0);
+    const auto usage = usage_of(evt);
+    REQUIRE(usage.count == 1);
+    REQUIRE(usage.max_used >= 24 * 1024);
+  }
+
+  SECTION("stack_usage: buckets") {
+    REQUIRE(evtlet::stack_usage::bucket_of(0) == 0);
+    REQUIRE(evtlet::stack_usage::bucket_of(1024) == 0);
+    REQUIRE(evtlet::stack_usage::bucket_of(1025) == 1);
+    REQUIRE(evtlet::stack_usage::bucket_of(size_t(1) << 40) ==
+            evtlet::stack_usage_buckets - 1);
+  }
+}
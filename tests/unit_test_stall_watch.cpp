@@ -0,0 +1,104 @@
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/algo/round_robin.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/evt/evt_priority.hpp>
+#include <evtlet/rt/stall_watch.hpp>
+#include <evtlet/rt/worker_pool.hpp>
+
+using namespace std::chrono_literals;
+
+class hog_evt : public evtlet::evt_fiber<size_t> {
+protected:
+  virtual size_t func() {
+    // busy for 100ms, counting the yields requested by the watchdog
+    size_t nyield = 0;
+    const auto until = std::chrono::steady_clock::now() + 100ms;
+    while (std::chrono::steady_clock::now() < until) {
+      if (evtlet::maybe_yield()) {
+        ++nyield;
+      }
+    }
+    return nyield;
+  }
+};
+
+TEST_CASE("test maybe_yield without a watchdog") {
+  REQUIRE(evtlet::stall_slot::current() == nullptr);
+  REQUIRE(!evtlet::maybe_yield());
+}
+
+TEST_CASE("test stall_watchdog") {
+  std::mutex lock;
+  std::vector<std::string> tags;
+  auto watchdog = std::make_shared<evtlet::stall_watchdog>(
+      10ms, 2ms, [&lock, &tags](const evtlet::stall_report &report) {
+        std::unique_lock<std::mutex> lck(lock);
+        tags.emplace_back(report.tag ? report.tag : "");
+      });
+
+  SECTION("stall_watched: a hog is reported with its event tag") {
+    size_t nyield = 0;
+    size_t nother = 0;
+    std::thread worker([&watchdog, &nyield, &nother]() {
+      boost::fibers::use_scheduling_algorithm<
+          evtlet::stall_watched<evtlet::priority_scheduler>>(watchdog);
+      hog_evt hog;
+      boost::fibers::fiber other([&nother]() {
+        for (size_t ii = 0; ii < 1000; ++ii) {
+          ++nother;
+          boost::this_fiber::yield();
+        }
+      });
+      nyield = hog.get();
+      other.join();
+    });
+    worker.join();
+    std::unique_lock<std::mutex> lck(lock);
+    REQUIRE(!tags.empty());
+    REQUIRE(tags.front() == typeid(hog_evt).name());
+    REQUIRE(nyield > 0);
+    REQUIRE(nother == 1000);
+  }
+
+  SECTION("stall_watched: short fibers are not reported") {
+    std::thread worker([&watchdog]() {
+      boost::fibers::use_scheduling_algorithm<
+          evtlet::stall_watched<boost::fibers::algo::round_robin>>(watchdog);
+      std::vector<boost::fibers::fiber> fibers;
+      for (size_t ii = 0; ii < 4; ++ii) {
+        fibers.emplace_back([]() {
+          const auto until = std::chrono::steady_clock::now() + 50ms;
+          while (std::chrono::steady_clock::now() < until) {
+            boost::this_fiber::yield();
+          }
+        });
+      }
+      for (auto &ff : fibers) {
+        ff.join();
+      }
+    });
+    worker.join();
+    REQUIRE(watchdog->reported() == 0);
+  }
+}
+
+TEST_CASE("test worker_pool with a stall_watchdog") {
+  auto watchdog = std::make_shared<evtlet::stall_watchdog>(
+      10ms, 2ms, [](const evtlet::stall_report &) {});
+  evtlet::worker_pool pool(2, false, evtlet::placement::PLACE_NONE, watchdog);
+  hog_evt hog;
+  REQUIRE(hog.get() > 0);
+  REQUIRE(watchdog->reported() > 0);
+}
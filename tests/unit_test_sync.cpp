@@ -0,0 +1,220 @@
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/rt/worker_pool.hpp>
+#include <evtlet/sync/adaptive_mutex.hpp>
+#include <evtlet/sync/fiber_mask.hpp>
+#include <evtlet/sync/latch.hpp>
+#include <evtlet/sync/semaphore.hpp>
+#include <evtlet/sync/shared_mutex.hpp>
+
+DEFMASK_T(phase_t, size_t, PH_NONE = 0, PH_READY = 1, PH_DONE = 2);
+
+template <typename Fn> static void run_fibers(size_t nfibers, Fn &&fn) {
+  std::vector<boost::fibers::fiber> fibers;
+  for (size_t ii = 0; ii < nfibers; ++ii) {
+    fibers.emplace_back([&fn, ii]() { fn(ii); });
+  }
+  for (auto &ff : fibers) {
+    ff.join();
+  }
+}
+
+class adaptive_int
+    : public evtlet::evt_fiber<int, evtlet::adaptive_mutex,
+                               evtlet::adaptive_condition> {
+public:
+  explicit adaptive_int(int value) : m_value(value) {}
+
+protected:
+  const int m_value;
+  virtual int func() { return m_value; }
+};
+
+TEST_CASE("test adaptive_mutex") {
+  SECTION("adaptive_mutex: mutual exclusion across yields") {
+    evtlet::adaptive_mutex mtx;
+    size_t inside = 0, max_inside = 0, total = 0;
+    run_fibers(8, [&](size_t) {
+      for (size_t ii = 0; ii < 10; ++ii) {
+        std::unique_lock<evtlet::adaptive_mutex> lck(mtx);
+        ++inside;
+        max_inside = std::max(max_inside, inside);
+        boost::this_fiber::yield();
+        --inside;
+        ++total;
+      }
+    });
+    REQUIRE(max_inside == 1);
+    REQUIRE(total == 80);
+  }
+
+  SECTION("adaptive_mutex: as condition_lock_t for evt_fiber") {
+    adaptive_int evt(-5);
+    REQUIRE(evt.get() == -5);
+    REQUIRE(evt.get_state() == evtlet::evt_state::STATE_DONE);
+  }
+}
+
+TEST_CASE("test shared_mutex") {
+  evtlet::shared_mutex mtx;
+  size_t readers = 0, max_readers = 0, writers = 0;
+  bool overlap = false;
+  run_fibers(6, [&](size_t ii) {
+    if (ii % 3 == 0) {
+      std::unique_lock<evtlet::shared_mutex> lck(mtx);
+      ++writers;
+      overlap = overlap || readers || writers > 1;
+      boost::this_fiber::yield();
+      --writers;
+    } else {
+      std::shared_lock<evtlet::shared_mutex> lck(mtx);
+      ++readers;
+      overlap = overlap || writers;
+      max_readers = std::max(max_readers, readers);
+      boost::this_fiber::yield();
+      --readers;
+    }
+  });
+  REQUIRE(!overlap);
+  REQUIRE(max_readers >= 1);
+
+  REQUIRE(mtx.try_lock_shared());
+  REQUIRE(!mtx.try_lock());
+  mtx.unlock_shared();
+  REQUIRE(mtx.try_lock());
+  REQUIRE(!mtx.try_lock_shared());
+  mtx.unlock();
+}
+
+TEST_CASE("test semaphore") {
+  evtlet::semaphore sem(2, 1);
+  size_t inside = 0, max_inside = 0;
+  run_fibers(8, [&](size_t) {
+    sem.acquire();
+    ++inside;
+    max_inside = std::max(max_inside, inside);
+    for (size_t ii = 0; ii < 4; ++ii) {
+      boost::this_fiber::yield();
+    }
+    --inside;
+    sem.release();
+  });
+  REQUIRE(max_inside == 2);
+  REQUIRE(sem.available() == 2);
+  REQUIRE(sem.try_acquire());
+  REQUIRE(sem.try_acquire());
+  REQUIRE(!sem.try_acquire());
+  sem.release(2);
+  REQUIRE(sem.available() == 2);
+}
+
+TEST_CASE("test latch and barrier") {
+  SECTION("latch: wait for all fibers") {
+    evtlet::latch done(4, 0);
+    size_t arrived = 0;
+    boost::fibers::fiber waiter([&]() {
+      done.wait();
+      REQUIRE(arrived == 4);
+    });
+    run_fibers(4, [&](size_t) {
+      boost::this_fiber::yield();
+      ++arrived;
+      done.count_down();
+    });
+    waiter.join();
+    REQUIRE(done.try_wait());
+  }
+
+  SECTION("barrier: phases are reusable") {
+    evtlet::barrier sync(3, 2);
+    std::vector<size_t> phase_of(3, 0);
+    size_t nlast = 0;
+    bool ordered = true;
+    run_fibers(3, [&](size_t ii) {
+      for (size_t phase = 0; phase < 5; ++phase) {
+        phase_of[ii] = phase;
+        if (sync.arrive_and_wait()) {
+          ++nlast;
+        }
+        for (auto pp : phase_of) {
+          ordered = ordered && pp >= phase;
+        }
+      }
+    });
+    REQUIRE(ordered);
+    REQUIRE(nlast == 5);
+  }
+}
+
+TEST_CASE("test latch and barrier destroyed after waiting") {
+  evtlet::worker_pool pool(3, true);
+  for (size_t ii = 0; ii < 50; ++ii) {
+    // the last worker may still be within count_down() when the waiter
+    // sees the count reach zero
+    auto done = std::make_unique<evtlet::latch>(2);
+    for (size_t ww = 1; ww < pool.size(); ++ww) {
+      pool.post(ww, [&done]() { done->count_down(); });
+    }
+    done->wait();
+    done.reset();
+  }
+
+  for (size_t ii = 0; ii < 50; ++ii) {
+    auto sync = std::make_unique<evtlet::barrier>(2);
+    auto left = std::make_unique<evtlet::latch>(1);
+    pool.post(1, [&sync, &left]() {
+      sync->arrive_and_wait();
+      left->count_down();
+    });
+    if (sync->arrive_and_wait()) {
+      // the worker may still be waiting within the barrier
+      left->wait();
+    }
+    // else the worker, arriving last, may still be within the barrier
+    sync.reset();
+    left->wait();
+    left.reset();
+  }
+}
+
+TEST_CASE("test fiber_mask") {
+  SECTION("fiber_mask: waiters park until notified") {
+    evtlet::fiber_mask<phase_t> phase(phase_t::PH_NONE, 2);
+    size_t nwoken = 0;
+    std::vector<boost::fibers::fiber> waiters;
+    for (size_t ii = 0; ii < 3; ++ii) {
+      waiters.emplace_back([&phase, &nwoken]() {
+        for (auto st = phase.load(); !(st & phase_t::PH_DONE);
+             st = phase.load()) {
+          phase.wait(st);
+        }
+        ++nwoken;
+      });
+    }
+    run_fibers(1, [&phase](size_t) {
+      for (size_t ii = 0; ii < 8; ++ii) {
+        boost::this_fiber::yield();
+      }
+      phase.fetch_or(phase_t::PH_READY);
+      phase.notify_all();
+      boost::this_fiber::yield();
+      REQUIRE(phase.fetch_or(phase_t::PH_DONE) == phase_t::PH_READY);
+      phase.notify_all();
+    });
+    for (auto &ww : waiters) {
+      ww.join();
+    }
+    REQUIRE(nwoken == 3);
+    REQUIRE(phase.test(phase_t::PH_READY | phase_t::PH_DONE));
+  }
+}
@@ -0,0 +1,220 @@
+
+#include <chrono>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+
+#include <evtlet/evt/evt_fiber.hpp>
+#include <evtlet/io/loopback_stream.hpp>
+#include <evtlet/rt/virtual_time.hpp>
+
+using namespace std::chrono_literals;
+
+// run `fn` on a new thread under a virtual_scheduler
+template <typename Fn> static void simulate(uint64_t seed, Fn &&fn) {
+  std::thread thr([seed, &fn]() {
+    boost::fibers::use_scheduling_algorithm<evtlet::virtual_scheduler>(seed);
+    fn();
+  });
+  thr.join();
+}
+
+// fibers sleeping for pseudo-random virtual durations, recording the
+// order in which each fiber runs
+static std::vector<size_t> run_order(uint64_t seed) {
+  std::vector<size_t> order;
+  simulate(seed, [&order]() {
+    std::vector<boost::fibers::fiber> fibers;
+    for (size_t ii = 0; ii < 8; ++ii) {
+      fibers.emplace_back([ii, &order]() {
+        for (size_t step = 0; step < 4; ++step) {
+          order.push_back(ii);
+          if (step % 2) {
+            evtlet::vsleep_for(std::chrono::milliseconds((ii * 7) % 3));
+          } else {
+            boost::this_fiber::yield();
+          }
+        }
+      });
+    }
+    for (auto &ff : fibers) {
+      ff.join();
+    }
+  });
+  return order;
+}
+
+class timeout_evt : public evtlet::evt_fiber<evtlet::clock::duration> {
+protected:
+  virtual evtlet::clock::duration func() {
+    const auto start = evtlet::clock::now();
+    evtlet::vsleep_for(30s);
+    return evtlet::clock::now() - start;
+  }
+};
+
+TEST_CASE("test virtual_scheduler") {
+  SECTION("virtual_scheduler: hours of virtual time, without waiting") {
+    const auto real_start = std::chrono::steady_clock::now();
+    size_t nwoken = 0;
+    bool exact = true;
+    size_t nadvance = 0;
+    evtlet::clock::duration total{};
+    simulate(1, [&]() {
+      auto *sched = evtlet::virtual_scheduler::current();
+      const auto start = evtlet::clock::now();
+      std::vector<boost::fibers::fiber> fibers;
+      for (size_t ii = 0; ii < 100; ++ii) {
+        fibers.emplace_back([ii, start, &nwoken, &exact]() {
+          for (size_t hour = 1; hour <= 10; ++hour) {
+            const auto at = start + std::chrono::hours(hour) +
+                            std::chrono::seconds(ii);
+            evtlet::vsleep_until(at);
+            exact = exact && evtlet::clock::now() == at;
+          }
+          ++nwoken;
+        });
+      }
+      for (auto &ff : fibers) {
+        ff.join();
+      }
+      total = evtlet::clock::now() - start;
+      nadvance = sched->advanced();
+    });
+    REQUIRE(total == 10h + 99s);
+    REQUIRE(nwoken == 100);
+    REQUIRE(exact);
+    REQUIRE(nadvance == 1000);
+    REQUIRE(std::chrono::steady_clock::now() - real_start < 10s);
+  }
+
+  SECTION("virtual_scheduler: reproducible order for a seed") {
+    const auto order = run_order(42);
+    REQUIRE(order.size() == 32);
+    REQUIRE(run_order(42) == order);
+    REQUIRE(run_order(43) != order);
+  }
+
+  SECTION("virtual_scheduler: evt_fiber timeouts in virtual time") {
+    evtlet::clock::duration elapsed{};
+    simulate(7, [&elapsed]() {
+      timeout_evt evt;
+      elapsed = evt.get();
+    });
+    REQUIRE(elapsed == 30s);
+  }
+
+  SECTION("virtual_scheduler: standard sleeps ordered with virtual timers") {
+    std::vector<char> order;
+    evtlet::clock::duration slept{};
+    evtlet::clock::duration total{};
+    size_t nreal = 0;
+    size_t nreal_vsleep = 0;
+    simulate(3, [&]() {
+      auto *sched = evtlet::virtual_scheduler::current();
+      const auto start = evtlet::clock::now();
+      boost::fibers::fiber aa([&order, &slept]() {
+        const auto at = evtlet::clock::now();
+        boost::this_fiber::sleep_for(20ms);
+        slept = evtlet::clock::now() - at;
+        order.push_back('a');
+      });
+      boost::fibers::fiber bb([&order]() {
+        evtlet::vsleep_for(10ms);
+        order.push_back('b');
+      });
+      boost::fibers::fiber cc([&order]() {
+        evtlet::vsleep_for(1h);
+        order.push_back('c');
+      });
+      aa.join();
+      bb.join();
+      cc.join();
+      total = evtlet::clock::now() - start;
+      nreal = sched->real_waits();
+    });
+    simulate(3, [&nreal_vsleep]() {
+      evtlet::vsleep_for(1h);
+      nreal_vsleep = evtlet::virtual_scheduler::current()->real_waits();
+    });
+    REQUIRE(order == std::vector<char>{'b', 'a', 'c'});
+    REQUIRE(slept >= 20ms);
+    REQUIRE(total == 1h);
+    REQUIRE(nreal > 0);
+    REQUIRE(nreal_vsleep == 0);
+  }
+
+  SECTION("loopback_stream: request and response in virtual time") {
+    const auto real_start = std::chrono::steady_clock::now();
+    size_t ncalls = 0;
+    bool exact = true;
+    std::string last;
+    size_t nreal = 0;
+    bool eof = false;
+    bool epipe = false;
+    simulate(5, [&]() {
+      auto ends = evtlet::loopback_pair(50ms);
+      evtlet::loopback_stream &client = ends.first;
+      evtlet::loopback_stream &server = ends.second;
+      boost::fibers::fiber srv([&server]() {
+        char buf[64];
+        size_t nn;
+        while ((nn = server.read_some(buf, sizeof(buf))) > 0) {
+          evtlet::vsleep_for(1s);
+          server.write("re:", 3);
+          server.write(buf, nn);
+        }
+        server.close();
+      });
+      for (size_t ii = 0; ii < 1000; ++ii) {
+        const std::string req = std::to_string(ii);
+        const auto start = evtlet::clock::now();
+        client.write(req.data(), req.size());
+        std::string rsp;
+        char buf[64];
+        size_t nn = 1;
+        while (nn && rsp.size() < req.size() + 3) {
+          nn = client.read_some(buf, sizeof(buf));
+          rsp.append(buf, nn);
+        }
+        // latency in each direction, and the server's processing time
+        exact = exact && evtlet::clock::now() - start == 1100ms;
+        ++ncalls;
+        last = rsp;
+      }
+      // the server closes on end of stream
+      client.close();
+      srv.join();
+      auto other = evtlet::loopback_pair();
+      other.second.close();
+      char buf[1];
+      eof = other.first.read_some(buf, 1) == 0;
+      try {
+        other.first.write("x", 1);
+      } catch (const std::system_error &exc) {
+        epipe = exc.code().value() == EPIPE;
+      }
+      nreal = evtlet::virtual_scheduler::current()->real_waits();
+    });
+    REQUIRE(ncalls == 1000);
+    REQUIRE(exact);
+    REQUIRE(last == "re:999");
+    REQUIRE(eof);
+    REQUIRE(epipe);
+    REQUIRE(nreal == 0);
+    REQUIRE(std::chrono::steady_clock::now() - real_start < 10s);
+  }
+
+  SECTION("vsleep_for: real time without a virtual_scheduler") {
+    REQUIRE(evtlet::virtual_scheduler::current() == nullptr);
+    const auto start = std::chrono::steady_clock::now();
+    evtlet::vsleep_for(5ms);
+    REQUIRE(std::chrono::steady_clock::now() - start >= 4ms);
+  }
+}